@@ -0,0 +1,202 @@
+/*
+ * Generates benchmark instances for reliability.
+ *
+ * usage: gen_graph <family> <size> <seed> <prefix>
+ *
+ * Families:
+ *   grid    <size> x <size> grid; terminals at opposite corners
+ *   ladder  2 x <size> ladder; terminals at opposite corners
+ *   rgg     random geometric graph of <size> vertices in the unit square
+ *   isp     ISP-like topology: a core ring with chords and dual-homed
+ *           access vertices, <size> vertices in total
+ *
+ * Writes <prefix>.dat (edge list), <prefix>_t.dat (terminals),
+ * <prefix>_p.dat (edge availabilities) and <prefix>_v.dat (vertex
+ * availabilities).  Vertices are numbered so that the edge order given by
+ * the edge list keeps the frontier small.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef std::pair<int,int> Edge;
+
+struct Instance {
+    int n;
+    std::vector<Edge> edges;
+    std::vector<int> terminals;
+};
+
+static void addEdge(Instance& g, std::set<Edge>& seen, int u, int v) {
+    if (u == v) return;
+    Edge e(std::min(u, v), std::max(u, v));
+    if (seen.insert(e).second) g.edges.push_back(e);
+}
+
+static Instance grid(int k) {
+    Instance g;
+    std::set<Edge> seen;
+    g.n = k * k;
+    for (int i = 0; i < k; ++i) {
+        for (int j = 0; j < k; ++j) {
+            int v = i * k + j + 1;
+            if (j + 1 < k) addEdge(g, seen, v, v + 1);
+            if (i + 1 < k) addEdge(g, seen, v, v + k);
+        }
+    }
+    g.terminals.push_back(1);
+    g.terminals.push_back(g.n);
+    return g;
+}
+
+static Instance ladder(int k) {
+    Instance g;
+    std::set<Edge> seen;
+    g.n = 2 * k;
+    for (int j = 0; j < k; ++j) {
+        int u = 2 * j + 1;
+        addEdge(g, seen, u, u + 1);
+        if (j + 1 < k) {
+            addEdge(g, seen, u, u + 2);
+            addEdge(g, seen, u + 1, u + 3);
+        }
+    }
+    g.terminals.push_back(1);
+    g.terminals.push_back(g.n);
+    return g;
+}
+
+static int findRoot(std::vector<int>& parent, int v) {
+    while (parent[v] != v) v = parent[v] = parent[parent[v]];
+    return v;
+}
+
+static Instance rgg(int n, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<std::pair<double,double> > pt(n);
+    for (int v = 0; v < n; ++v) {
+        pt[v] = std::make_pair(uniform(rng), uniform(rng));
+    }
+    std::sort(pt.begin(), pt.end()); // sweep along the x axis
+
+    double r = std::sqrt(2.0 * std::log(double(n)) / (M_PI * n));
+    Instance g;
+    std::set<Edge> seen;
+    std::vector<int> parent(n + 1);
+    g.n = n;
+    for (int v = 0; v <= n; ++v) parent[v] = v;
+
+    for (int u = 0; u < n; ++u) {
+        for (int v = u + 1; v < n && pt[v].first - pt[u].first < r; ++v) {
+            double dy = pt[v].second - pt[u].second;
+            double dx = pt[v].first - pt[u].first;
+            if (dx * dx + dy * dy < r * r) {
+                addEdge(g, seen, u + 1, v + 1);
+                parent[findRoot(parent, u + 1)] = findRoot(parent, v + 1);
+            }
+        }
+    }
+
+    // join the components to the nearest preceding vertex
+    for (int v = 1; v < n; ++v) {
+        if (findRoot(parent, v + 1) == findRoot(parent, v)) continue;
+        addEdge(g, seen, v, v + 1);
+        parent[findRoot(parent, v + 1)] = findRoot(parent, v);
+    }
+
+    std::sort(g.edges.begin(), g.edges.end());
+    g.terminals.push_back(1);
+    g.terminals.push_back(n);
+    return g;
+}
+
+static Instance isp(int n, std::mt19937_64& rng) {
+    int core = std::max(4, n / 5);
+    if (n < core + 2) throw std::runtime_error("isp: too few vertices");
+
+    Instance g;
+    std::set<Edge> seen;
+    g.n = n;
+
+    // core ring with chords between nearby routers
+    for (int v = 1; v <= core; ++v) {
+        addEdge(g, seen, v, v % core + 1);
+    }
+    std::uniform_int_distribution<int> router(1, core);
+    for (int k = 0; k < core / 3; ++k) {
+        int u = router(rng);
+        int v = (u + 1 + rng() % 3) % core + 1;
+        addEdge(g, seen, u, v);
+    }
+
+    // dual-homed access vertices attached to neighboring routers
+    for (int v = core + 1; v <= n; ++v) {
+        int a = 1 + (v - core - 1) * core / (n - core);
+        addEdge(g, seen, a, v);
+        addEdge(g, seen, a % core + 1, v);
+    }
+
+    std::sort(g.edges.begin(), g.edges.end());
+    g.terminals.push_back(core + 1);
+    g.terminals.push_back(n);
+    return g;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 5) {
+        std::cerr << "usage: " << argv[0]
+                << " grid|ladder|rgg|isp <size> <seed> <prefix>\n";
+        return 1;
+    }
+
+    std::string family = argv[1];
+    int size = std::atoi(argv[2]);
+    std::mt19937_64 rng(std::strtoull(argv[3], 0, 10));
+    std::string prefix = argv[4];
+
+    try {
+        Instance g;
+        if (family == "grid") g = grid(size);
+        else if (family == "ladder") g = ladder(size);
+        else if (family == "rgg") g = rgg(size, rng);
+        else if (family == "isp") g = isp(size, rng);
+        else throw std::runtime_error("unknown family: " + family);
+
+        std::ofstream graph((prefix + ".dat").c_str());
+        for (size_t k = 0; k < g.edges.size(); ++k) {
+            graph << g.edges[k].first << " " << g.edges[k].second << "\n";
+        }
+
+        std::ofstream term((prefix + "_t.dat").c_str());
+        for (size_t k = 0; k < g.terminals.size(); ++k) {
+            term << (k ? " " : "") << g.terminals[k];
+        }
+        term << "\n";
+
+        std::uniform_real_distribution<double> edgeProb(0.9, 0.99);
+        std::ofstream prob((prefix + "_p.dat").c_str());
+        for (size_t k = 0; k < g.edges.size(); ++k) {
+            prob << edgeProb(rng) << "\n";
+        }
+
+        std::uniform_real_distribution<double> vertexProb(0.95, 0.999);
+        std::ofstream vprob((prefix + "_v.dat").c_str());
+        for (int v = 1; v <= g.n; ++v) {
+            vprob << v << " " << vertexProb(rng) << "\n";
+        }
+    }
+    catch (std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#!/bin/sh
+# Generates the benchmark instances and runs reliability on them.
+#
+# usage: bench/run.sh [ <csv_file> ]
+#
+# Each run appends a row with phase times, peak RSS and node counts to
+# <csv_file> (default: bench/results.csv).  Compare the files of two builds
+# to see performance changes.
+
+set -e
+
+cd "$(dirname "$0")/.."
+CSV=${1:-bench/results.csv}
+DATA=bench/data
+mkdir -p "$DATA"
+rm -f "$CSV"
+
+GEN=bench/gen_graph
+REL=./reliability
+
+# family size seed
+EDGE_INSTANCES="
+grid 4 1
+grid 5 1
+grid 6 1
+grid 7 1
+grid 8 1
+grid 9 1
+ladder 20 1
+ladder 100 1
+rgg 30 1
+rgg 40 1
+rgg 50 1
+isp 30 1
+isp 40 1
+isp 60 1
+"
+
+# small instances for vertex reliability and alg_k
+VERTEX_INSTANCES="
+grid 4 1
+grid 5 1
+ladder 10 1
+rgg 20 1
+isp 20 1
+"
+
+run() {
+    echo "$*" >&2
+    "$REL" -quiet -csv "$CSV" "$@" >/dev/null
+}
+
+echo "$EDGE_INSTANCES" | while read family size seed; do
+    [ -z "$family" ] && continue
+    name=$DATA/${family}${size}_${seed}
+    $GEN $family $size $seed $name
+    run $name.dat ${name}_t.dat ${name}_p.dat
+    run -reduce $name.dat ${name}_t.dat ${name}_p.dat
+done
+
+echo "$VERTEX_INSTANCES" | while read family size seed; do
+    [ -z "$family" ] && continue
+    name=$DATA/${family}${size}_${seed}
+    $GEN $family $size $seed $name
+    run -vertex -alg_k --vertexfile=${name}_v.dat \
+        $name.dat ${name}_t.dat ${name}_p.dat
+done
+
+echo "results: $CSV" >&2
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tdzdd/DdEval.hpp"
+
+/**
+ * Probabilities of one node at several time points.
+ */
+struct ProbLanes {
+    static int const SIZE = 8; ///< The number of time points per pass.
+    double v[SIZE];
+};
+
+/**
+ * Evaluator of the probability of reaching the 1-terminal at several time
+ * points at once.
+ * The loop over the lanes has no dependency, so that the compiler can
+ * vectorize it.
+ */
+class ProbCurveEval: public tdzdd::DdEval<ProbCurveEval,ProbLanes,ProbLanes> {
+    std::vector<double> const& prob; ///< prob[level * SIZE + k] for lane k.
+
+public:
+    ProbCurveEval(std::vector<double> const& prob) : prob(prob) {
+    }
+
+    void evalTerminal(ProbLanes& p, bool one) const {
+        std::fill(p.v, p.v + ProbLanes::SIZE, one ? 1.0 : 0.0);
+    }
+
+    void evalNode(ProbLanes& p, int level,
+                  tdzdd::DdValues<ProbLanes,2> const& values) const {
+        double const* const pc = &prob[level * ProbLanes::SIZE];
+        double const* const v0 = values.get(0).v;
+        double const* const v1 = values.get(1).v;
+        for (int k = 0; k < ProbLanes::SIZE; ++k) {
+            p.v[k] = v0[k] * (1 - pc[k]) + v1[k] * pc[k];
+        }
+    }
+};
+
+/**
+ * Reliability as a function of time, where the variable at each level is
+ * available with probability exp(-rate * t).
+ */
+class ReliabilityCurve {
+    std::vector<double> const& rate;
+
+public:
+    /**
+     * Constructor.
+     * @param rate failure rate of each level; index 0 is unused.
+     */
+    ReliabilityCurve(std::vector<double> const& rate) : rate(rate) {
+    }
+
+    /**
+     * Evaluates the reliability at time points.
+     * Each pass over the DD evaluates ProbLanes::SIZE time points.
+     * @param dd the BDD.
+     * @param times the time points.
+     * @return the reliability at each time point.
+     */
+    template<typename DD>
+    std::vector<double> evaluate(DD const& dd,
+                                 std::vector<double> const& times) const {
+        int const lanes = ProbLanes::SIZE;
+        int const n = rate.size() - 1;
+        std::vector<double> result(times.size());
+        std::vector<double> prob((n + 1) * lanes);
+
+        for (size_t t0 = 0; t0 < times.size(); t0 += lanes) {
+            for (int i = 1; i <= n; ++i) {
+                for (int k = 0; k < lanes; ++k) {
+                    double t = times[std::min(t0 + k, times.size() - 1)];
+                    prob[i * lanes + k] = std::exp(-rate[i] * t);
+                }
+            }
+
+            ProbLanes r = dd.evaluate(ProbCurveEval(prob));
+            for (int k = 0; k < lanes && t0 + k < times.size(); ++k) {
+                result[t0 + k] = r.v[k];
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Integrates a curve by the trapezoidal rule.
+     * The mean time to failure is the integral of the reliability from 0 to
+     * infinity; the result is truncated at the last time point.
+     * @param times the time points in increasing order.
+     * @param values the reliability at each time point.
+     * @return the integral from the first to the last time point.
+     */
+    static double integrate(std::vector<double> const& times,
+                            std::vector<double> const& values) {
+        double s = 0.0;
+        for (size_t k = 1; k < times.size(); ++k) {
+            s += (times[k] - times[k - 1]) * (values[k] + values[k - 1]) / 2;
+        }
+        return s;
+    }
+};
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include "tdzdd/DdStructure.hpp"
+#include "tdzdd/util/Graph.hpp"
+
+/**
+ * Directory of built DDs keyed by a hash of what determines them.
+ *
+ * The key covers the graph after Graph::update(), its terminal colors and
+ * a description of the spec, but not the probabilities, so that a run with
+ * other probabilities on the same topology loads the DD instead of
+ * building it.  Each DD is stored as <key>.dd by DdStructure::writeBinary.
+ * Loading a file renews its modification time, and storing a file removes
+ * the least recently used files until the directory fits in the size limit.
+ */
+class DdCache {
+    std::string const dir;
+    uint64_t const maxBytes;
+
+    struct Entry {
+        time_t time;
+        uint64_t size;
+        std::string path;
+
+        bool operator<(Entry const& o) const {
+            return time < o.time;
+        }
+    };
+
+    /**
+     * Hash of a sequence of words in two independent lanes.
+     */
+    class Hasher {
+        uint64_t h[2];
+
+        static uint64_t mix(uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+    public:
+        Hasher() {
+            h[0] = 0x243f6a8885a308d3ULL;
+            h[1] = 0x13198a2e03707344ULL;
+        }
+
+        void add(uint64_t x) {
+            h[0] = mix(h[0] ^ x) + 0x9e3779b97f4a7c15ULL;
+            h[1] = mix(h[1] + x * 0xff51afd7ed558ccdULL) ^ h[0];
+        }
+
+        std::string hex() const {
+            char buf[33];
+            std::snprintf(buf, sizeof(buf), "%016llx%016llx",
+                          static_cast<unsigned long long>(h[0]),
+                          static_cast<unsigned long long>(h[1]));
+            return buf;
+        }
+    };
+
+public:
+    /**
+     * Constructor.
+     * @param dir the cache directory, which is created if missing.
+     * @param maxBytes the maximum total size of the cached files.
+     * @exception std::runtime_error the directory cannot be created.
+     */
+    DdCache(std::string const& dir, uint64_t maxBytes)
+            : dir(dir), maxBytes(maxBytes) {
+        if (mkdir(dir.c_str(), 0777) != 0 && errno != EEXIST) {
+            throw std::runtime_error("cannot create " + dir + ": "
+                    + std::strerror(errno));
+        }
+    }
+
+    /**
+     * Computes the key of a DD.
+     * @param graph the graph after Graph::update().
+     * @param spec description of everything else that affects the DD.
+     * @return the key in hexadecimal.
+     */
+    static std::string key(tdzdd::Graph const& graph, std::string const& spec) {
+        Hasher h;
+        h.add(graph.isDirected());
+        h.add(graph.vertexSize());
+        h.add(graph.edgeSize());
+        for (int a = 0; a < graph.edgeSize(); ++a) {
+            tdzdd::Graph::EdgeInfo const& e = graph.edgeInfo(a);
+            h.add((uint64_t(e.v1) << 33) | (uint64_t(e.v2) << 1) | e.reversed);
+        }
+        for (int v = 1; v <= graph.vertexSize(); ++v) {
+            h.add(graph.colorNumber(v));
+        }
+        h.add(spec.size());
+        for (size_t i = 0; i < spec.size(); ++i) {
+            h.add(static_cast<unsigned char>(spec[i]));
+        }
+        return h.hex();
+    }
+
+    std::string path(std::string const& key) const {
+        return dir + "/" + key + ".dd";
+    }
+
+    /**
+     * Loads a DD.
+     * A broken file is removed.
+     * @param key the key of the DD.
+     * @param dd the DD to be replaced.
+     * @return true if the DD is found.
+     */
+    template<int ARITY>
+    bool load(std::string const& key, tdzdd::DdStructure<ARITY>& dd) const {
+        std::string const file = path(key);
+        std::ifstream ifs(file.c_str(), std::ios::binary);
+        if (!ifs) return false;
+
+        try {
+            dd.readBinary(ifs);
+        }
+        catch (std::runtime_error&) {
+            dd = tdzdd::DdStructure<ARITY>();
+            std::remove(file.c_str());
+            return false;
+        }
+        utime(file.c_str(), 0);
+        return true;
+    }
+
+    /**
+     * Stores a DD and evicts the least recently used DDs over the limit.
+     * The file is written under a temporary name and renamed, so that
+     * concurrent runs never see a partial file.
+     * @param key the key of the DD.
+     * @param dd the DD.
+     * @exception std::runtime_error the file cannot be written.
+     */
+    template<int ARITY>
+    void store(std::string const& key,
+               tdzdd::DdStructure<ARITY> const& dd) const {
+        std::string const file = path(key);
+        std::ostringstream oss;
+        oss << file << ".tmp" << getpid();
+        std::string const tmp = oss.str();
+
+        {
+            std::ofstream ofs(tmp.c_str(), std::ios::binary);
+            if (!ofs) throw std::runtime_error("cannot open " + tmp);
+            dd.writeBinary(ofs);
+            if (!ofs) {
+                std::remove(tmp.c_str());
+                throw std::runtime_error("cannot write " + tmp);
+            }
+        }
+
+        if (std::rename(tmp.c_str(), file.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            throw std::runtime_error("cannot write " + file);
+        }
+        evict();
+    }
+
+private:
+    void evict() const {
+        DIR* d = opendir(dir.c_str());
+        if (d == 0) return;
+
+        std::vector<Entry> entries;
+        uint64_t total = 0;
+        while (dirent* e = readdir(d)) {
+            std::string name = e->d_name;
+            if (name.size() < 3 || name.compare(name.size() - 3, 3, ".dd") != 0) {
+                continue;
+            }
+            Entry entry;
+            entry.path = dir + "/" + name;
+            struct stat st;
+            if (stat(entry.path.c_str(), &st) != 0) continue;
+            entry.time = st.st_mtime;
+            entry.size = st.st_size;
+            entries.push_back(entry);
+            total += entry.size;
+        }
+        closedir(d);
+
+        std::sort(entries.begin(), entries.end());
+        for (size_t k = 0; k < entries.size() && total > maxBytes; ++k) {
+            if (std::remove(entries[k].path.c_str()) == 0) {
+                total -= entries[k].size;
+            }
+        }
+    }
+};
@@ -0,0 +1,103 @@
+#include <stdexcept>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include "tdzdd/FlatDdStructure.hpp"
+#include "tdzdd/util/MyVector.hpp"
+#include "probability.hpp"
+
+/**
+ * Reliability conditioned on observed states of some edges.
+ *
+ * Since edges fail independently, fixing the probability of an observed
+ * edge to 0 or 1 gives the conditional reliability.  The probability of
+ * reaching the 1-terminal from each node is computed once without
+ * evidence.  A query recomputes only the nodes at or above the lowest
+ * observed level and reads the cached values of the nodes below it, so
+ * evidence on the upper levels is answered in time proportional to the
+ * upper part of the BDD.
+ * Queries share a work area and must not be run concurrently.
+ */
+class ConditionalReliability {
+public:
+    typedef uint32_t Index;
+    typedef tdzdd::FlatDdStructure<2> Diagram;
+
+    /**
+     * Observed state of the variable at a level.
+     */
+    typedef std::pair<int,bool> Evidence;
+
+private:
+    Diagram const& dd;
+    std::vector<double> const prob;
+    std::vector<double> given;
+    tdzdd::MyVector<double> cache;
+    tdzdd::MyVector<double> upper;
+
+public:
+    /**
+     * Constructor.
+     * @param dd the BDD.
+     * @param prob probability of taking 1 at each level; index 0 is unused.
+     */
+    ConditionalReliability(Diagram const& dd, std::vector<double> const& prob)
+            : dd(dd), prob(prob), given(prob) {
+        dd.evaluate(ProbEval(prob), cache);
+    }
+
+    /**
+     * Gets the reliability without evidence.
+     * @return the probability of reaching the 1-terminal.
+     */
+    double reliability() const {
+        return cache[dd.root()];
+    }
+
+    /**
+     * Computes the reliability conditioned on evidence.
+     * @param evidence observed levels and their values.
+     * @return the conditional probability of reaching the 1-terminal.
+     * @exception std::out_of_range a level is out of range.
+     */
+    double query(std::vector<Evidence> const& evidence) {
+        int const n = prob.size() - 1;
+        int lowest = n + 1;
+        for (size_t k = 0; k < evidence.size(); ++k) {
+            int i = evidence[k].first;
+            if (i < 1 || n < i) throw std::out_of_range(
+                    "ConditionalReliability: level out of range");
+            given[i] = evidence[k].second ? 1.0 : 0.0;
+            if (i < lowest) lowest = i;
+        }
+
+        double r;
+        if (lowest > dd.topLevel()) {
+            r = reliability();
+        }
+        else {
+            Index const base = dd.levelBegin(lowest);
+            Index const root = dd.root();
+            upper.resize(root + 1 - base);
+            double const* const c = cache.data();
+            double* const u = upper.data(); // u[f - base] for node f
+
+            for (Index f = base; f <= root; ++f) {
+                Index const f0 = dd.child(f, 0);
+                Index const f1 = dd.child(f, 1);
+                double const v0 = f0 < base ? c[f0] : u[f0 - base];
+                double const v1 = f1 < base ? c[f1] : u[f1 - base];
+                double const p = given[dd.level(f)];
+                u[f - base] = v0 * (1 - p) + v1 * p;
+            }
+            r = u[root - base];
+        }
+
+        for (size_t k = 0; k < evidence.size(); ++k) {
+            int i = evidence[k].first;
+            given[i] = prob[i];
+        }
+        return r;
+    }
+};
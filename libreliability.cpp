@@ -0,0 +1,258 @@
+/*
+ * libreliability: C interface to the network reliability computation
+ *
+ * See reliability.h for the functions.  The pipeline is the same as the
+ * default mode of reliability.cpp: FrontierBasedSearch builds the edge BDD
+ * and computeVertexReliability extends it to imperfect vertices.
+ */
+
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "tdzdd/DdEval.hpp"
+#include "tdzdd/DdStructure.hpp"
+#include "tdzdd/spec/FrontierBasedSearch.hpp"
+#include "tdzdd/spec/SapporoBdd.hpp"
+#include "tdzdd/util/Graph.hpp"
+#include "vertex_rel.hpp"
+#include "reliability.h"
+
+struct rel_graph {
+    tdzdd::Graph graph;
+    std::vector<int> ids; ///< Vertex id of each vertex number.
+};
+
+struct rel_dd {
+    rel_graph const* graph;
+    tdzdd::DdStructure<2> dd;
+};
+
+namespace {
+
+thread_local std::string lastError;
+
+/**
+ * Evaluator of the probability of reaching the 1-terminal, which reads
+ * the probability of level i at prob[offset + stride * i].
+ */
+class ArrayProbEval: public tdzdd::DdEval<ArrayProbEval,double> {
+    double const* prob;
+    int offset;
+    int stride;
+
+public:
+    ArrayProbEval(double const* prob, int offset, int stride)
+            : prob(prob), offset(offset), stride(stride) {
+    }
+
+    void evalTerminal(double& p, bool one) const {
+        p = one ? 1.0 : 0.0;
+    }
+
+    void evalNode(double& p, int level,
+                  tdzdd::DdValues<double,2> const& values) const {
+        double pc = prob[offset + stride * level];
+        p = values.get(0) * (1 - pc) + values.get(1) * pc;
+    }
+};
+
+int fail(std::string const& message) {
+    lastError = message;
+    return -1;
+}
+
+} // namespace
+
+extern "C" {
+
+rel_graph* rel_graph_create(int num_edges, int const* edges,
+                            int num_terminals, int const* terminals) {
+    try {
+        if (num_edges <= 0 || edges == 0) {
+            fail("rel_graph_create: no edges");
+            return 0;
+        }
+        if (num_terminals < 0 || (num_terminals > 0 && terminals == 0)) {
+            fail("rel_graph_create: invalid terminals");
+            return 0;
+        }
+        for (int i = 0; i < 2 * num_edges; ++i) {
+            if (edges[i] < 0) {
+                fail("rel_graph_create: negative vertex id");
+                return 0;
+            }
+        }
+
+        rel_graph* g = new rel_graph;
+        try {
+            tdzdd::Graph& graph = g->graph;
+            for (int i = 0; i < num_edges; ++i) {
+                graph.addEdge(std::to_string(edges[2 * i]),
+                              std::to_string(edges[2 * i + 1]));
+            }
+            graph.update();
+
+            if (num_terminals > 0) {
+                for (int k = 0; k < num_terminals; ++k) {
+                    graph.setColor(std::to_string(terminals[k]), 0);
+                }
+            }
+            else {
+                for (int v = 1; v <= graph.vertexSize(); ++v) {
+                    graph.setColor(graph.vertexName(v), 0);
+                }
+            }
+            graph.update();
+
+            g->ids.resize(graph.vertexSize() + 1);
+            for (int v = 1; v <= graph.vertexSize(); ++v) {
+                g->ids[v] = std::atoi(graph.vertexName(v).c_str());
+            }
+        }
+        catch (...) {
+            delete g;
+            throw;
+        }
+        return g;
+    }
+    catch (std::exception& e) {
+        fail(e.what());
+        return 0;
+    }
+}
+
+int rel_graph_num_edges(rel_graph const* graph) {
+    return graph->graph.edgeSize();
+}
+
+int rel_graph_num_vertices(rel_graph const* graph) {
+    return graph->graph.vertexSize();
+}
+
+void rel_graph_free(rel_graph* graph) {
+    delete graph;
+}
+
+rel_dd* rel_dd_build(rel_graph const* graph) {
+    try {
+        rel_dd* d = new rel_dd;
+        d->graph = graph;
+        try {
+            // look ahead cannot be used for BDDs
+            tdzdd::FrontierBasedSearch fbs(graph->graph, -1, false, false);
+            d->dd = tdzdd::DdStructure<2>(fbs);
+        }
+        catch (...) {
+            delete d;
+            throw;
+        }
+        return d;
+    }
+    catch (std::exception& e) {
+        fail(e.what());
+        return 0;
+    }
+}
+
+rel_dd* rel_dd_load(rel_graph const* graph, char const* path) {
+    try {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) {
+            fail(std::string("rel_dd_load: cannot open ") + path);
+            return 0;
+        }
+
+        rel_dd* d = new rel_dd;
+        d->graph = graph;
+        try {
+            d->dd.readBinary(ifs);
+        }
+        catch (...) {
+            delete d;
+            throw;
+        }
+        if (d->dd.topLevel() > graph->graph.edgeSize()) {
+            delete d;
+            fail(std::string("rel_dd_load: not a BDD of the graph: ") + path);
+            return 0;
+        }
+        return d;
+    }
+    catch (std::exception& e) {
+        fail(e.what());
+        return 0;
+    }
+}
+
+int rel_dd_save(rel_dd const* dd, char const* path) {
+    try {
+        std::ofstream ofs(path, std::ios::binary);
+        if (!ofs) return fail(std::string("rel_dd_save: cannot open ") + path);
+        dd->dd.writeBinary(ofs);
+        if (!ofs) return fail(std::string("rel_dd_save: cannot write ") + path);
+        return 0;
+    }
+    catch (std::exception& e) {
+        return fail(e.what());
+    }
+}
+
+size_t rel_dd_size(rel_dd const* dd) {
+    return dd->dd.size();
+}
+
+int rel_dd_evaluate(rel_dd const* dd, double const* edge_probs,
+                    double* result) {
+    try {
+        // Level i is edge m - i
+        int const m = dd->graph->graph.edgeSize();
+        *result = dd->dd.evaluate(ArrayProbEval(edge_probs, m, -1));
+        return 0;
+    }
+    catch (std::exception& e) {
+        return fail(e.what());
+    }
+}
+
+int rel_vertex_reliability(rel_dd const* dd, double const* edge_probs,
+                           double const* vertex_probs, double* result) {
+    try {
+        rel_graph const& g = *dd->graph;
+        int const m = g.graph.edgeSize();
+
+        GlobalVariables gv;
+        gv.graph = &g.graph;
+        gv.edge_dd = &dd->dd;
+        gv.edge_prob_list.assign(edge_probs, edge_probs + m);
+        for (int v = 1; v <= g.graph.vertexSize(); ++v) {
+            gv.vertex_prob_map[g.graph.vertexName(v)] = vertex_probs[g.ids[v]];
+        }
+
+        bddp vertex_dd = computeVertexReliability(gv);
+        delete[] gv.v_list;
+        delete[] gv.e_list;
+
+        BDD vertex_dd_s = BDD_ID(vertex_dd);
+        tdzdd::DdStructure<2> vertex_dd_structure(
+                (tdzdd::SapporoBdd(vertex_dd_s)));
+        *result = vertex_dd_structure.evaluate(
+                ArrayProbEval(&gv.edge_vertex_prob_list[0], 0, 1));
+        return 0;
+    }
+    catch (std::exception& e) {
+        return fail(e.what());
+    }
+}
+
+void rel_dd_free(rel_dd* dd) {
+    delete dd;
+}
+
+char const* rel_last_error(void) {
+    return lastError.c_str();
+}
+
+} // extern "C"
@@ -0,0 +1,225 @@
+#include <cmath>
+#include <random>
+#include <stdint.h>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "tdzdd/util/Graph.hpp"
+#include "probability.hpp"
+
+/**
+ * Result of a Monte Carlo reliability estimation.
+ */
+struct MonteCarloResult {
+    double estimate;   ///< Estimated reliability.
+    double stdError;   ///< Standard error of the estimate.
+    double lower;      ///< Lower end of the 95% confidence interval.
+    double upper;      ///< Upper end of the 95% confidence interval.
+    long long samples; ///< The number of samples actually drawn.
+};
+
+/**
+ * Monte Carlo estimator of network reliability.
+ *
+ * Each sample decides the states of all edges and checks by union-find
+ * whether the terminals are connected in the same way as required by
+ * FrontierBasedSearch: vertices with the same color must be connected and
+ * vertices with different colors must not.
+ *
+ * Edge states are drawn by dagger sampling (Kumamoto et al., 1977):
+ * an edge with failure probability q fails in at most one sample of each
+ * run of floor(1/q) consecutive samples, which keeps the marginal failure
+ * probability q but makes rare failures spread evenly over the samples.
+ * Samples are grouped into batches whose means are independent, so the
+ * confidence interval is computed from the variance of the batch means.
+ */
+class MonteCarloReliability {
+    tdzdd::Graph const& graph;
+    std::vector<double> const& edge_prob_list;
+
+    static int findRoot(std::vector<int>& parent, int v) {
+        while (parent[v] != v) {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
+    }
+
+    /**
+     * Decides the failed edges of each sample in a batch.
+     * @param failed failed[s] receives the failed edges of the s-th sample.
+     * @param rng random number generator.
+     */
+    void sampleBatch(std::vector<std::vector<int> >& failed,
+                     std::mt19937_64& rng) const {
+        int const batchSize = failed.size();
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        int const m = graph.edgeSize();
+
+        for (int s = 0; s < batchSize; ++s) {
+            failed[s].clear();
+        }
+
+        for (int a = 0; a < m; ++a) {
+            double const q = 1.0 - edge_prob_list[a];
+            if (q <= 0.0) continue;
+
+            if (q >= 0.5) { // a dagger covers only one sample
+                for (int s = 0; s < batchSize; ++s) {
+                    if (uniform(rng) < q) failed[s].push_back(a);
+                }
+                continue;
+            }
+
+            int const k = static_cast<int>(1.0 / q);
+            for (int s0 = 0; s0 < batchSize; s0 += k) {
+                int const r = std::min(k, batchSize - s0);
+                double const u = uniform(rng);
+                if (u < q * r) {
+                    int const s = s0 + std::min(static_cast<int>(u / q), r - 1);
+                    failed[s].push_back(a);
+                }
+            }
+        }
+    }
+
+    /**
+     * Checks the connectivity of the terminals.
+     * @param failed the failed edges.
+     * @param parent work area for union-find.
+     * @param rootOfColor work area for color representatives.
+     * @param down work area for edge states.
+     * @return true if the terminals are connected.
+     */
+    bool isConnected(std::vector<int> const& failed, std::vector<int>& parent,
+                     std::vector<int>& rootOfColor,
+                     std::vector<char>& down) const {
+        int const n = graph.vertexSize();
+        int const m = graph.edgeSize();
+
+        for (int v = 0; v <= n; ++v) {
+            parent[v] = v;
+        }
+        for (size_t k = 0; k < failed.size(); ++k) {
+            down[failed[k]] = 1;
+        }
+
+        for (int a = 0; a < m; ++a) {
+            if (down[a]) continue;
+            tdzdd::Graph::EdgeInfo const& e = graph.edgeInfo(a);
+            int r1 = findRoot(parent, e.v1);
+            int r2 = findRoot(parent, e.v2);
+            if (r1 != r2) parent[r1] = r2;
+        }
+
+        for (size_t k = 0; k < failed.size(); ++k) {
+            down[failed[k]] = 0;
+        }
+
+        std::fill(rootOfColor.begin(), rootOfColor.end(), 0);
+        for (int v = 1; v <= n; ++v) {
+            int c = graph.colorNumber(v);
+            if (c == 0) continue;
+            int r = findRoot(parent, v);
+            if (rootOfColor[c] == 0) {
+                rootOfColor[c] = r;
+            }
+            else if (rootOfColor[c] != r) {
+                return false;
+            }
+        }
+
+        // vertices with different colors must not be connected
+        for (int c = 1; c <= graph.numColor(); ++c) {
+            for (int cc = c + 1; cc <= graph.numColor(); ++cc) {
+                if (rootOfColor[c] != 0 && rootOfColor[c] == rootOfColor[cc]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    int chooseBatchSize(long long samples) const {
+        // as long as the longest dagger, but at least 32 batches
+        double k = 1;
+        for (int a = 0; a < graph.edgeSize(); ++a) {
+            double q = 1.0 - edge_prob_list[a];
+            if (q > 0.0 && 1.0 / q > k) k = 1.0 / q;
+        }
+        long long b = std::min(static_cast<long long>(k), 1LL << 16);
+        b = std::min(b, std::max(samples / 32, 1LL));
+        return static_cast<int>(std::max(b, 1LL));
+    }
+
+public:
+    /**
+     * Constructor.
+     * @param graph the graph with terminals given as vertex colors.
+     * @param edge_prob_list availability of each edge.
+     */
+    MonteCarloReliability(tdzdd::Graph const& graph,
+                          std::vector<double> const& edge_prob_list)
+            : graph(graph), edge_prob_list(edge_prob_list) {
+    }
+
+    /**
+     * Estimates the reliability.
+     * The result depends only on @p samples and @p seed, not on the number
+     * of threads.
+     * @param samples the number of samples; rounded up to a whole batch.
+     * @param seed seed of the random number generator.
+     * @return the estimate and its 95% confidence interval.
+     */
+    MonteCarloResult estimate(long long samples, uint64_t seed) const {
+        int const batchSize = chooseBatchSize(samples);
+        long long const numBatches = std::max(
+                (samples + batchSize - 1) / batchSize, 2LL);
+        std::vector<double> batchMean(numBatches);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            std::vector<std::vector<int> > failed(batchSize);
+            std::vector<int> parent(graph.vertexSize() + 1);
+            std::vector<int> rootOfColor(graph.numColor() + 1);
+            std::vector<char> down(graph.edgeSize());
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (long long b = 0; b < numBatches; ++b) {
+                std::mt19937_64 rng(streamSeed(seed, b));
+                sampleBatch(failed, rng);
+                long long ok = 0;
+                for (int s = 0; s < batchSize; ++s) {
+                    if (isConnected(failed[s], parent, rootOfColor, down)) ++ok;
+                }
+                batchMean[b] = double(ok) / batchSize;
+            }
+        }
+
+        double sum = 0;
+        for (long long b = 0; b < numBatches; ++b) {
+            sum += batchMean[b];
+        }
+        double const mean = sum / numBatches;
+        double ss = 0;
+        for (long long b = 0; b < numBatches; ++b) {
+            ss += (batchMean[b] - mean) * (batchMean[b] - mean);
+        }
+        double const se = std::sqrt(ss / (numBatches - 1) / numBatches);
+
+        MonteCarloResult r;
+        r.estimate = mean;
+        r.stdError = se;
+        r.lower = std::max(0.0, mean - 1.96 * se);
+        r.upper = std::min(1.0, mean + 1.96 * se);
+        r.samples = numBatches * batchSize;
+        return r;
+    }
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "tdzdd/DdEval.hpp"
+
+/**
+ * Bottom-up evaluator of the probability of reaching a terminal of a BDD.
+ * The variable at level i takes 1 with probability prob[i]; index 0 is
+ * unused.
+ */
+class ProbEval: public tdzdd::DdEval<ProbEval,double> {
+    std::vector<double> const& prob;
+    bool const target;
+
+public:
+    /**
+     * Constructor.
+     * @param prob probability of taking 1 at each level, which must
+     *        outlive the evaluator.
+     * @param target the terminal to be reached.
+     */
+    ProbEval(std::vector<double> const& prob, bool target = true)
+            : prob(prob), target(target) {
+    }
+
+    void evalTerminal(double& v, bool one) const {
+        v = one == target ? 1.0 : 0.0;
+    }
+
+    void evalNode(double& v, int level,
+                  tdzdd::DdValues<double,2> const& values) const {
+        v = values.get(0) * (1 - prob[level]) + values.get(1) * prob[level];
+    }
+};
+
+/**
+ * Finalizer of SplitMix64, which scrambles the bits of a word.
+ */
+inline uint64_t splitMix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Mixes a seed and a stream number into the seed of the stream, so that
+ * random numbers do not depend on the threads that draw each stream.
+ */
+inline uint64_t streamSeed(uint64_t seed, uint64_t stream) {
+    return splitMix(seed + (stream + 1) * 0x9e3779b97f4a7c15ULL);
+}
@@ -42,26 +42,29 @@
 
 #include "tdzdd/DdSpecOp.hpp"
 #include "tdzdd/DdStructure.hpp"
+#include "tdzdd/CompactDdStructure.hpp"
+#include "tdzdd/FlatDdStructure.hpp"
 #include "tdzdd/DdEval.hpp"
 #include "tdzdd/util/Graph.hpp"
+#include "tdzdd/spec/AllPairsConnectivity.hpp"
+#include "tdzdd/spec/DirectedReachability.hpp"
 #include "tdzdd/spec/FrontierBasedSearch.hpp"
+#include "tdzdd/spec/HopConstrainedConnectivity.hpp"
+#include "tdzdd/spec/ReachableSiteCount.hpp"
 #include "tdzdd/spec/SapporoBdd.hpp"
+#include "tdzdd/spec/TwoTerminalFlow.hpp"
 #endif
 
-class GlobalVariables {
-public:
-    std::vector<double> edge_prob_list;
-    std::map<std::string, double> vertex_prob_map;
-    std::vector<double> edge_vertex_prob_list;
-    int* v_list;
-    int* e_list;
-    const tdzdd::Graph* graph;
-    const tdzdd::DdStructure<2>* edge_dd;
-    BDD shifted_edge_dd;
-};
-
 #include "vertex_rel.hpp"
 #include "alg_k.hpp"
+#include "probability.hpp"
+#include "montecarlo.hpp"
+#include "topk.hpp"
+#include "sampler.hpp"
+#include "evidence.hpp"
+#include "curve.hpp"
+#include "ddcache.hpp"
+#include "tokenizer.hpp"
 
 //#include "FrontierBasedSearch.hpp"
 //#include "Graph.hpp"
@@ -79,29 +82,41 @@ std::string options[][2] = { //
         {"export", "Dump result ZDD to STDOUT"},
         {"vertex", "Compute the reliability with imperfect vertices"},
         {"alg_k", "Run alg_k"},
+        {"limit <n>", "Fall back to Monte Carlo when #node exceeds <n>"},
+        {"montecarlo", "Estimate the reliability by Monte Carlo sampling"},
+        {"samples <n>", "Draw <n> Monte Carlo samples (default: 1000000)"},
+        {"seed <n>", "Seed for random numbers (default: 1)"},
+        {"threads <n>", "Use <n> threads"},
+        {"width <n>", "Bound the reliability by DDs of width at most <n>"},
+        {"profile <file>", "Write per-level construction statistics to <file> in JSON"},
+        {"csv <file>", "Append timings, peak memory and node counts to <file>"},
+        {"compact", "Evaluate the BDD in the compact form with 32-bit node references"},
+        {"flat", "Evaluate the BDD in the flat bottom-up layout with prefetching"},
+        {"repeat <n>", "Repeat the evaluation <n> times and report the mean time"},
+        {"topk <n>", "Print the <n> most probable failure patterns disconnecting the terminals"},
+        {"topk_connected", "Make -topk print the most probable patterns connecting the terminals"},
+        {"sample <n>", "Draw <n> edge states conditioned on connected terminals"},
+        {"sample_disconnected", "Make -sample draw edge states conditioned on disconnected terminals"},
+        {"evidence <file>", "Print the reliability given each line of edge states in <file> (- for STDIN)"},
+        {"rates <file>", "Read failure rates of edges to evaluate availability exp(-rate*t)"},
+        {"curve <file>", "Write reliability at each time of --times=<start>:<end>:<n> to <file> in CSV"},
+        {"mttf", "Report the mean time to failure integrated over the time grid"},
+        {"allpairs <file>", "Print the reliability of every pair of sites listed in <file>"},
+        {"srlg <file>", "Read shared-risk link groups that fail together from <file>"},
+        {"states <file>", "Read probabilities of up and degraded edges from <file> and compute the reliability with and without degraded edges"},
+        {"hops <n>", "Connect each terminal to the first one in <vertex_group_file> by at most <n> edges"},
+        {"directed", "Read edges as arcs and compute the reachability from the first terminal"},
+        {"demand <n>", "Compute the probability that two terminals can carry a flow of <n> units"},
+        {"capacity <file>", "Read integer capacities of edges for -demand (default: 1)"},
+        {"expected", "Print the distribution and expectation of the number of terminals connected to the first one"},
+        {"batch <file>", "Compute the reliability of each line <graph_file> [<vertex_group_file> [<prob_file>]] of <file> in parallel and print CSV"},
+        {"hugepages <n>", "Allocate blocks of <n> MiB or more from huge pages (0 for 2 MiB)"},
         {"quiet", "Suppress output and only show OK/NG for vertex_dd == h comparison"}}; //
 
 std::map<std::string,bool> opt;
 std::map<std::string,int> optNum;
 std::map<std::string,std::string> optStr;
 
-class ProbEval: public tdzdd::DdEval<ProbEval,double> {
-private:
-    std::vector<double> prob_list_;
-    
-public:
-    ProbEval(const std::vector<double>& edge_prob_list) : prob_list_(edge_prob_list) { }
-    
-    void evalTerminal(double& p, bool one) const {
-        p = one ? 1.0 : 0.0;
-    }
-
-    void evalNode(double& p, int level, DdValues<double, 2> const& values) const {
-        double pc = prob_list_[level];
-        p = values.get(0) * (1 - pc) + values.get(1) * pc;
-    }
-};
-
 void usage(char const* cmd) {
     std::cerr << "usage: " << cmd
                 << " [ <option>... ] [ <graph_file> [ <vertex_group_file> [ <prob_file> ]]]\n";
@@ -115,6 +130,335 @@ void usage(char const* cmd) {
     }
 }
 
+void runMonteCarlo(Graph const& graph, std::vector<double> const& edge_prob_list,
+                   MessageHandler& mh) {
+    long long samples = opt["samples"] ? optNum["samples"] : 1000000;
+    uint64_t seed = opt["seed"] ? optNum["seed"] : 1;
+
+    MessageHandler mhmc;
+    if (!opt["quiet"]) mhmc.begin("Monte Carlo") << " ...";
+    MonteCarloResult r = MonteCarloReliability(graph, edge_prob_list)
+            .estimate(samples, seed);
+    if (!opt["quiet"]) mhmc.end();
+
+    if (!opt["quiet"]) {
+        mh << "\n#sample = " << r.samples << ", prob = "
+           << std::setprecision(10) << r.estimate
+           << ", stderr = " << r.stdError
+           << ", 95% CI = [" << r.lower << ", " << r.upper << "]\n";
+    }
+}
+
+void runAllPairs(Graph const& graph, std::vector<double> const& edge_prob_list,
+                 MessageHandler& mh) {
+    std::ifstream ifs(optStr["allpairs"].c_str());
+    if (!ifs) throw std::runtime_error("ERROR: cannot open " + optStr["allpairs"]);
+    std::vector<std::string> names;
+    std::vector<int> sites;
+    std::string name;
+    while (ifs >> name) {
+        names.push_back(name);
+        sites.push_back(graph.getVertex(name));
+    }
+
+    std::vector<double> prob(edge_prob_list.rbegin(), edge_prob_list.rend());
+    prob.insert(prob.begin(), 0.0);
+    AllPairsConnectivity::ComponentMass finished;
+    AllPairsConnectivity spec(graph, sites, prob, &finished);
+    DdStructure<2> dd(spec);
+    std::vector<double> matrix = AllPairsConnectivity::pairMatrix(finished,
+            sites.size());
+
+    if (!opt["quiet"]) mh << "\n#node = " << dd.size() << "\n";
+    int const k = sites.size();
+    std::cout << "site";
+    for (int b = 0; b < k; ++b) {
+        std::cout << "," << names[b];
+    }
+    std::cout << "\n" << std::setprecision(10);
+    for (int a = 0; a < k; ++a) {
+        std::cout << names[a];
+        for (int b = 0; b < k; ++b) {
+            std::cout << "," << matrix[a * k + b];
+        }
+        std::cout << "\n";
+    }
+}
+
+/**
+ * Reads shared-risk link groups, one per line as the probability that the
+ * group works followed by its edges numbered from 1.
+ */
+void readGroups(std::string const& fileName, int numEdges,
+                std::vector<std::vector<int> >& groups,
+                std::vector<double>& group_prob_list) {
+    std::ifstream ifs(fileName.c_str());
+    if (!ifs) throw std::runtime_error("ERROR: cannot open " + fileName);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        std::istringstream iss(line);
+        double p;
+        if (!(iss >> p)) continue;
+        std::vector<int> edges;
+        int e;
+        while (iss >> e) {
+            if (e < 1 || numEdges < e) throw std::runtime_error(
+                    "ERROR: no such edge in " + fileName + ": " + line);
+            edges.push_back(e - 1);
+        }
+        groups.push_back(edges);
+        group_prob_list.push_back(p);
+    }
+}
+
+/**
+ * Reads the terminals in the order of the vertex group file.
+ */
+std::vector<int> readTerminals(Graph const& graph,
+                               std::string const& termFileName) {
+    std::vector<int> terminals;
+    if (opt["allrel"] || termFileName.empty()) return terminals;
+    MappedFile file(termFileName);
+    Tokenizer tok(file.begin(), file.end());
+    char const* s;
+    size_t n;
+    while (tok.next(s, n)) {
+        terminals.push_back(graph.getVertex(std::string(s, n)));
+    }
+    return terminals;
+}
+
+/**
+ * Gets the source terminal, which is the first vertex in the vertex group
+ * file; 0 if there is none.
+ */
+int readSourceTerminal(Graph const& graph, std::string const& termFileName) {
+    std::vector<int> terminals = readTerminals(graph, termFileName);
+    return terminals.empty() ? 0 : terminals[0];
+}
+
+/**
+ * Computes the expected number of terminals connected to the first one and
+ * prints the probability of each number in CSV.
+ */
+void runExpectedSites(Graph const& graph,
+                      std::vector<double> const& edge_prob_list,
+                      std::string const& termFileName, MessageHandler& mh) {
+    int const source = readSourceTerminal(graph, termFileName);
+    if (source == 0) throw std::runtime_error(
+            "ERROR: -expected option needs <vertex_group_file>.");
+
+    std::vector<double> prob(edge_prob_list.rbegin(), edge_prob_list.rend());
+    prob.insert(prob.begin(), 0.0);
+    std::vector<double> distribution;
+    ReachableSiteCount spec(graph, source, prob, &distribution);
+    DdStructure<2> dd(spec);
+
+    if (!opt["quiet"]) {
+        mh << "\n#node = " << dd.size() << std::setprecision(10)
+           << ", expected = " << ReachableSiteCount::expectation(distribution)
+           << "\n";
+    }
+    std::cout << "sites,probability\n" << std::setprecision(10);
+    for (size_t c = 0; c < distribution.size(); ++c) {
+        std::cout << c << "," << distribution[c] << "\n";
+    }
+}
+
+/**
+ * Computes the reliability of edges that are down, degraded or up, where
+ * degraded edges carry connectivity.
+ * Connectivity does not tell degraded edges from up ones, so both the
+ * reliability and the reliability with up edges alone come from one binary
+ * DD evaluated with the probabilities of the two kinds of working edges.
+ */
+void runMultiState(Graph const& graph, MessageHandler& mh) {
+    int const m = graph.edgeSize();
+    std::ifstream ifs(optStr["states"].c_str());
+    if (!ifs) throw std::runtime_error("ERROR: cannot open " + optStr["states"]);
+    std::vector<double> working(m + 1), up(m + 1);
+    for (int a = 0; a < m; ++a) {
+        double pu, pd;
+        if (!(ifs >> pu >> pd)) throw std::runtime_error(
+                "ERROR: please put probabilities of up and degraded states!");
+        if (pu < 0.0 || pd < 0.0 || pu + pd > 1.0 + 1e-9) {
+            throw std::runtime_error(
+                    "ERROR: probabilities of up and degraded states must be nonnegative and sum to at most 1!");
+        }
+        int const level = m - a;
+        up[level] = pu;
+        working[level] = std::min(pu + pd, 1.0);
+    }
+
+    FrontierBasedSearch fbs(graph, -1, false, false);
+    DdStructure<2> dd(fbs);
+
+    double const any = dd.evaluate(ProbEval(working));
+    double const full = dd.evaluate(ProbEval(up));
+
+    if (!opt["quiet"]) {
+        mh << "\n#node = " << dd.size() << std::setprecision(10)
+           << ", prob = " << any << ", prob (up edges only) = " << full
+           << ", prob (degraded edges needed) = " << any - full << "\n";
+    }
+}
+
+void writeProfile(DdProfile const& profile, std::string const& fileName) {
+    std::ofstream ofs(fileName.c_str());
+    if (!ofs) throw std::runtime_error("ERROR: cannot open " + fileName);
+    profile.dumpJson(ofs);
+}
+
+std::vector<int> readCapacities(std::string const& fileName, int count) {
+    std::ifstream ifs(fileName.c_str());
+    if (!ifs) throw std::runtime_error("ERROR: cannot open " + fileName);
+    std::vector<int> capacities;
+    int v;
+    while (static_cast<int>(capacities.size()) < count && ifs >> v) {
+        capacities.push_back(v);
+    }
+    if (static_cast<int>(capacities.size()) < count) {
+        throw std::runtime_error("ERROR: please put capacities!");
+    }
+    return capacities;
+}
+
+std::vector<double> readRates(std::string const& fileName, int count) {
+    std::ifstream ifs(fileName.c_str());
+    if (!ifs) throw std::runtime_error("ERROR: cannot open " + fileName);
+    std::vector<double> rates;
+    double v;
+    while (static_cast<int>(rates.size()) < count && ifs >> v) {
+        rates.push_back(v);
+    }
+    if (static_cast<int>(rates.size()) < count) {
+        throw std::runtime_error("ERROR: please put failure rates!");
+    }
+    return rates;
+}
+
+/**
+ * Describes what determines the edge BDD besides the graph and its colors,
+ * for the key of --cache option.
+ */
+std::string cacheSpec(Graph const& graph, std::string const& termFileName,
+                      std::vector<std::vector<int> > const& groups) {
+    std::ostringstream oss;
+    oss << "edge";
+    std::vector<int> terminals = readTerminals(graph, termFileName);
+    for (size_t k = 0; k < terminals.size(); ++k) {
+        oss << " t" << terminals[k];
+    }
+    for (size_t k = 0; k < groups.size(); ++k) {
+        oss << " g";
+        for (size_t j = 0; j < groups[k].size(); ++j) {
+            oss << " " << groups[k][j];
+        }
+    }
+    if (opt["hops"]) oss << " hops " << optNum["hops"];
+    if (opt["directed"]) oss << " directed";
+    if (opt["demand"]) {
+        oss << " demand " << optNum["demand"];
+        if (opt["capacity"]) {
+            std::vector<int> capacity = readCapacities(optStr["capacity"],
+                    graph.edgeSize());
+            for (size_t a = 0; a < capacity.size(); ++a) {
+                oss << " c" << capacity[a];
+            }
+        }
+    }
+    return oss.str();
+}
+
+/**
+ * Parses a time grid given as <start>:<end>:<n>.
+ */
+std::vector<double> parseTimeGrid(std::string const& spec) {
+    double start, end;
+    int n;
+    char c1, c2;
+    std::istringstream iss(spec);
+    if (!(iss >> start >> c1 >> end >> c2 >> n) || c1 != ':' || c2 != ':'
+        || n < 1) {
+        throw std::runtime_error("ERROR: --times must be <start>:<end>:<n>");
+    }
+    std::vector<double> times(n);
+    for (int k = 0; k < n; ++k) {
+        times[k] = n == 1 ? start : start + (end - start) * k / (n - 1);
+    }
+    return times;
+}
+
+void writeCurve(std::string const& fileName, std::vector<double> const& times,
+                std::vector<double> const& edgeCurve,
+                std::vector<double> const& vertexCurve) {
+    std::ofstream ofs(fileName.c_str());
+    if (!ofs) throw std::runtime_error("ERROR: cannot open " + fileName);
+    ofs << "time,reliability";
+    if (!vertexCurve.empty()) ofs << ",vertex_reliability";
+    ofs << "\n" << std::setprecision(10);
+    for (size_t k = 0; k < times.size(); ++k) {
+        ofs << times[k] << "," << edgeCurve[k];
+        if (!vertexCurve.empty()) ofs << "," << vertexCurve[k];
+        ofs << "\n";
+    }
+}
+
+/**
+ * Measurements of a run, appended to a CSV file by -csv option.
+ */
+struct RunReport {
+    std::string instance;
+    std::string options;
+    int vertices;
+    int edges;
+    double readTime;
+    double buildTime;
+    double evalTime;
+    double reduceTime;
+    double vertexTime;
+    double algkTime;
+    size_t nodes;
+    size_t reducedNodes;
+    size_t vertexNodes;
+    double prob;
+    double vertexProb;
+    long maxrss;
+
+    RunReport() :
+            vertices(0), edges(0), readTime(0), buildTime(0), evalTime(0),
+            reduceTime(0), vertexTime(0), algkTime(0), nodes(0),
+            reducedNodes(0), vertexNodes(0), prob(0), vertexProb(0),
+            maxrss(0) {
+    }
+
+    /**
+     * Appends a row to a CSV file, writing the header if the file is empty.
+     * @param fileName the CSV file.
+     */
+    void appendCsv(std::string const& fileName) const {
+        bool empty;
+        {
+            std::ifstream ifs(fileName.c_str());
+            empty = !ifs || ifs.peek() == std::ifstream::traits_type::eof();
+        }
+
+        std::ofstream ofs(fileName.c_str(), std::ios::app);
+        if (!ofs) throw std::runtime_error("ERROR: cannot open " + fileName);
+        if (empty) {
+            ofs << "instance,options,vertices,edges,read_time,build_time,"
+                << "eval_time,reduce_time,vertex_time,alg_k_time,nodes,"
+                << "reduced_nodes,vertex_nodes,prob,vertex_prob,maxrss_kb\n";
+        }
+        ofs << instance << "," << options << "," << vertices << "," << edges
+            << "," << readTime << "," << buildTime << "," << evalTime << ","
+            << reduceTime << "," << vertexTime << "," << algkTime << ","
+            << nodes << "," << reducedNodes << "," << vertexNodes << ","
+            << std::setprecision(10) << prob << "," << vertexProb << ","
+            << maxrss << "\n";
+    }
+};
+
 class EdgeDecorator {
     int const n;
     std::set<int> const& levels;
@@ -130,53 +474,257 @@ public:
     }
 };
 
+/**
+ * Reads an edge list, one edge per line as two vertex names optionally
+ * followed by the probability of the edge.  Call graph.update() afterwards.
+ */
 void parse_graph_file(const std::string& filename, tdzdd::Graph& graph, std::vector<double>& edge_prob_list) {
-    std::ifstream ifs(filename);
-    std::string line;
-    
-    while (std::getline(ifs, line)) {
-        std::istringstream iss(line);
-        std::string token1, token2;
-        double prob;
-        
-        if (iss >> token1 >> token2) {
-            graph.addEdge(token1, token2);
-            
-            if (iss >> prob) {
+    MappedFile file(filename);
+    Tokenizer tok(file.begin(), file.end());
+
+    while (!tok.eof()) {
+        char const* s1 = "";
+        char const* s2;
+        char const* s3;
+        size_t n1 = 0, n2, n3;
+
+        if (tok.nextInLine(s1, n1) && tok.nextInLine(s2, n2)) {
+            graph.addEdge(s1, n1, s2, n2);
+
+            double prob;
+            if (tok.nextInLine(s3, n3) && Tokenizer::toDouble(s3, n3, prob)) {
                 edge_prob_list.push_back(prob);
             }
         } else {
-            throw std::runtime_error("ERROR: Invalid line in graph file: " + line);
+            throw std::runtime_error("ERROR: Invalid line in graph file: "
+                    + std::string(s1, n1));
+        }
+        tok.nextLine();
+    }
+}
+
+/**
+ * Reads vertex groups, one group per line, and colors the vertices of each
+ * group.  Call graph.update() afterwards.
+ */
+void parse_vertex_group_file(const std::string& filename, tdzdd::Graph& graph) {
+    MappedFile file(filename);
+    Tokenizer tok(file.begin(), file.end());
+
+    for (int color = 0; !tok.eof(); ++color) {
+        char const* s;
+        size_t n;
+        while (tok.nextInLine(s, n)) {
+            graph.setColor(std::string(s, n), color);
         }
+        tok.nextLine();
     }
-    graph.update();
 }
 
+/**
+ * Reads numbers separated by white space, up to @p count of them.
+ */
+void parse_prob_file(const std::string& filename, int count,
+                     std::vector<double>& prob_list) {
+    MappedFile file(filename);
+    Tokenizer tok(file.begin(), file.end());
+    char const* s;
+    size_t n;
+    double v;
+    for (int c = 0; c < count && tok.next(s, n); ++c) {
+        if (!Tokenizer::toDouble(s, n, v)) break;
+        prob_list.push_back(v);
+    }
+}
+
+/**
+ * Reads vertex probabilities, one vertex per line as the name and the
+ * probability separated by white space or a comma.
+ */
 void parse_vertex_prob_file(const std::string& filename, std::map<std::string, double>& vertex_prob_map) {
-    std::ifstream ifs(filename.c_str());
-    if (!ifs) {
-        throw std::runtime_error("ERROR: Cannot open vertex probability file: " + filename);
+    MappedFile file(filename);
+    Tokenizer tok(file.begin(), file.end(), true);
+
+    while (!tok.eof()) {
+        char const* s1;
+        char const* s2;
+        size_t n1, n2;
+        double prob;
+
+        if (tok.nextInLine(s1, n1) && tok.nextInLine(s2, n2)
+                && Tokenizer::toDouble(s2, n2, prob)) {
+            vertex_prob_map[std::string(s1, n1)] = prob;
+        }
+        tok.nextLine();
     }
-    
-    std::string line;
-    while (std::getline(ifs, line)) {
-        if (line.empty()) continue;
-        
-        // Replace comma with space for uniform processing
-        for (size_t i = 0; i < line.length(); ++i) {
-            if (line[i] == ',') {
-                line[i] = ' ';
-            }
+}
+
+/**
+ * Reads a graph with its terminals and edge probabilities, which is shared
+ * by the single run and the jobs of -batch option.
+ * Without a vertex group file, every vertex is a terminal, and without
+ * probabilities, every edge works with probability 0.5.
+ * @param graphFileName the graph file.
+ * @param termFileName the vertex group file; empty for none.
+ * @param edgeProbFileName the edge probability file; empty for none.
+ * @param adjacencyList whether the graph file is an adjacency list.
+ * @param graph the graph, of which the direction is set by the caller.
+ * @param edge_prob_list receives the edge probabilities.
+ */
+void readInstance(std::string const& graphFileName,
+                  std::string const& termFileName,
+                  std::string const& edgeProbFileName, bool adjacencyList,
+                  Graph& graph, std::vector<double>& edge_prob_list) {
+    if (adjacencyList) {
+        graph.readAdjacencyList(graphFileName);
+    }
+    else {
+        parse_graph_file(graphFileName, graph, edge_prob_list);
+    }
+
+    if (!termFileName.empty()) {
+        MessageHandler mhr;
+        mhr.begin("reading") << " \"" << termFileName << "\" ...";
+        parse_vertex_group_file(termFileName, graph);
+        graph.update();
+        mhr.end();
+    } else { // Make all vertices terminals
+        graph.update();
+        for (int v = 1; v <= graph.vertexSize(); ++v) {
+            graph.setColor(graph.vertexName(v), 1);
         }
-        
-        std::istringstream iss(line);
-        std::string vertex_name;
-        double prob;
-        
-        if (iss >> vertex_name >> prob) {
-            vertex_prob_map[vertex_name] = prob;
+        graph.update();
+    }
+
+    if (!edgeProbFileName.empty()) {
+        parse_prob_file(edgeProbFileName, graph.edgeSize(), edge_prob_list);
+    } else if (edge_prob_list.empty()) { // All probabilities are 0.5.
+        edge_prob_list.assign(graph.edgeSize(), 0.5);
+    }
+    if (edge_prob_list.size() < static_cast<size_t>(graph.edgeSize())) {
+        throw std::runtime_error("ERROR: please put probabilities!");
+    }
+}
+
+/**
+ * A job of -batch option and its result.
+ */
+struct BatchJob {
+    std::string graphFileName;
+    std::string termFileName;
+    std::string edgeProbFileName;
+    int vertices;
+    int edges;
+    size_t nodes;
+    double prob;
+    double time;
+    std::string error;
+
+    BatchJob() :
+            vertices(0), edges(0), nodes(0), prob(0), time(0) {
+    }
+
+    /**
+     * Computes the reliability.
+     * The graph, the BDD and the evaluator belong to the job, so that jobs
+     * can run on different threads; global options must not be touched.
+     */
+    void run() {
+        double const start = getWallClockTime();
+        try {
+            Graph graph;
+            std::vector<double> edge_prob_list;
+            readInstance(graphFileName, termFileName, edgeProbFileName, false,
+                         graph, edge_prob_list);
+            if (graph.edgeSize() == 0)
+                throw std::runtime_error("ERROR: The graph is empty!");
+            vertices = graph.vertexSize();
+            edges = graph.edgeSize();
+
+            std::vector<double> edge_prob_rev_list(edge_prob_list.rbegin(), edge_prob_list.rend());
+            edge_prob_rev_list.insert(edge_prob_rev_list.begin(), 0.0);
+
+            FrontierBasedSearch fbs(graph, -1, false, false);
+            DdStructure<2> dd(fbs);
+            nodes = dd.size();
+            prob = dd.evaluate(ProbEval(edge_prob_rev_list));
+        }
+        catch (std::exception& e) {
+            error = e.what();
         }
+        time = getWallClockTime() - start;
+    }
+};
+
+std::string csvField(std::string const& s) {
+    if (s.find_first_of(",\"\n") == std::string::npos) return s;
+    std::string t = "\"";
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '"') t += '"';
+        t += s[i];
+    }
+    return t + "\"";
+}
+
+/**
+ * Runs the jobs listed in a manifest, one per line as
+ * <graph_file> [<vertex_group_file> [<prob_file>]], on a pool of threads
+ * and prints the results in CSV in the order of the manifest.
+ * Lines starting with # are ignored.
+ * @return the number of failed jobs.
+ */
+int runBatch(std::string const& manifest, MessageHandler& mh) {
+    std::vector<BatchJob> jobs;
+    {
+        MappedFile file(manifest);
+        Tokenizer tok(file.begin(), file.end());
+        while (!tok.eof()) {
+            char const* s;
+            size_t n;
+            if (tok.nextInLine(s, n) && *s != '#') {
+                BatchJob job;
+                job.graphFileName.assign(s, n);
+                if (tok.nextInLine(s, n)) {
+                    job.termFileName.assign(s, n);
+                    if (tok.nextInLine(s, n)) job.edgeProbFileName.assign(s, n);
+                }
+                jobs.push_back(job);
+            }
+            tok.nextLine();
+        }
+    }
+
+    // MessageHandler is not thread-safe.
+    bool const show = MessageHandler::showMessages(false);
+    double const start = getWallClockTime();
+    intmax_t const m = jobs.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (intmax_t k = 0; k < m; ++k) {
+        jobs[k].run();
+    }
+    double const elapsed = getWallClockTime() - start;
+    MessageHandler::showMessages(show);
+
+    int failed = 0;
+    std::cout << "graph,terminals,probabilities,vertices,edges,nodes,prob,"
+              << "time,error\n" << std::setprecision(10);
+    for (intmax_t k = 0; k < m; ++k) {
+        BatchJob const& job = jobs[k];
+        std::cout << csvField(job.graphFileName) << ","
+                  << csvField(job.termFileName) << ","
+                  << csvField(job.edgeProbFileName) << "," << job.vertices
+                  << "," << job.edges << "," << job.nodes << "," << job.prob
+                  << "," << job.time << "," << csvField(job.error) << "\n";
+        if (!job.error.empty()) ++failed;
+    }
+
+    if (!opt["quiet"]) {
+        mh << "\n#job = " << m << ", #failed = " << failed << ", "
+           << m / std::max(elapsed, 1e-9) << " jobs/s\n";
     }
+    return failed;
 }
 
 int main(int argc, char *argv[]) {
@@ -222,6 +770,10 @@ int main(int argc, char *argv[]) {
                     opt[s] = true;
                     optNum[s] = std::atoi(argv[++i]);
                 }
+                else if (i + 1 < argc && opt.count(s + " <file>")) {
+                    opt[s] = true;
+                    optStr[s] = argv[++i];
+                }
                 else if (i + 1 < argc && opt.count(s + " " + argv[i + 1])) {
                     opt[s] = true;
                     optStr[s] = argv[++i];
@@ -243,7 +795,7 @@ int main(int argc, char *argv[]) {
                 throw std::exception();
             }
         }
-        if (graphFileName.empty()) { // show usage
+        if (graphFileName.empty() && !opt["batch"]) { // show usage
             throw std::exception();
         }
     }
@@ -255,6 +807,14 @@ int main(int argc, char *argv[]) {
     if (!opt["quiet"]) {
         MessageHandler::showMessages();
     }
+    if (opt["hugepages"]) {
+        HugePageArena::configure(true, size_t(std::max(optNum["hugepages"], 0)) << 20);
+    }
+#ifdef _OPENMP
+    if (opt["threads"] && optNum["threads"] > 0) {
+        omp_set_num_threads(optNum["threads"]);
+    }
+#endif
     MessageHandler mh;
     
     // Suppress MessageHandler output in quiet mode
@@ -262,48 +822,48 @@ int main(int argc, char *argv[]) {
         mh.begin("started");
     }
 
+    RunReport report;
+    report.instance = graphFileName;
+    for (int i = 1; i < argc; ++i) {
+        std::string s = argv[i];
+        if (s == graphFileName || s == termFileName || s == edgeProbFileName) continue;
+        if (s == "-csv" || s == "--csv") { // keep rows comparable between outputs
+            ++i;
+            continue;
+        }
+        if (!report.options.empty()) report.options += " ";
+        report.options += s;
+    }
+    double phaseStart = getWallClockTime();
+
     Graph graph;
     std::vector<double> edge_prob_list;
     std::map<std::string, double> vertex_prob_map;
     try {
-        if (!graphFileName.empty()) {
-            if (opt["a"]) {
-                graph.readAdjacencyList(graphFileName);
-            }
-            else {
-                std::stringstream sstr;
-                parse_graph_file(graphFileName, graph, edge_prob_list);
-            }
-        }
-
-        if (!termFileName.empty() && !opt["allrel"]) {
-            graph.readVertexGroups(termFileName);
-        } else { // Make all vertices terminals
-            for (int v = 1; v <= graph.edgeSize(); ++v) {
-                graph.setColor(graph.vertexName(v), 1);
-            }
-            graph.update();
-        }
-
-        if (!edgeProbFileName.empty()) {
-            std::ifstream ifs(edgeProbFileName.c_str());
-            double v;
-            int c = 0;
-            while (ifs && ifs >> v && c < graph.edgeSize()) {
-                edge_prob_list.push_back(v);
-                ++c;
+        if (opt["batch"]) {
+            // Jobs only read their own files and build the edge BDD
+            for (std::map<std::string,std::string>::const_iterator t =
+                    optStr.begin(); t != optStr.end(); ++t) {
+                if (t->first != "batch") throw std::runtime_error(
+                        "ERROR: -batch option is only compatible with -threads, -hugepages and -quiet options.");
             }
-            if (edge_prob_list.size() < static_cast<size_t>(graph.edgeSize())) {
-                throw std::runtime_error("ERROR: please put probabilities!");
-            }
-        } else { // All probabilities are 0.5.
-            if (edge_prob_list.empty()) {
-                for (int i = 0; i < graph.edgeSize(); ++i) {
-                    edge_prob_list.push_back(0.5);
+            for (std::map<std::string,bool>::const_iterator t = opt.begin();
+                    t != opt.end(); ++t) {
+                if (t->second && t->first != "batch" && t->first != "threads"
+                    && t->first != "hugepages" && t->first != "quiet") {
+                    throw std::runtime_error(
+                            "ERROR: -batch option is only compatible with -threads, -hugepages and -quiet options.");
                 }
             }
+            int failed = runBatch(optStr["batch"], mh);
+            mh.end("finished");
+            return failed == 0 ? 0 : 1;
         }
 
+        graph.setDirected(opt["directed"]);
+        readInstance(graphFileName, opt["allrel"] ? "" : termFileName,
+                     edgeProbFileName, opt["a"], graph, edge_prob_list);
+
         // Load vertex probabilities if specified
         if (optStr.count("vertexfile") && !optStr["vertexfile"].empty()) {
             parse_vertex_prob_file(optStr["vertexfile"], vertex_prob_map);
@@ -323,6 +883,10 @@ int main(int argc, char *argv[]) {
         if (graph.edgeSize() == 0)
             throw std::runtime_error("ERROR: The graph is empty!");
 
+        report.vertices = graph.vertexSize();
+        report.edges = graph.edgeSize();
+        report.readTime = getWallClockTime() - phaseStart;
+
         if (opt["graph"]) {
             graph.dump(std::cout);
             return 0;
@@ -375,6 +939,86 @@ int main(int argc, char *argv[]) {
         }
         
 #endif
+        if (opt["directed"] && (opt["montecarlo"] || opt["allpairs"]
+                                || opt["expected"] || opt["states"]
+                                || opt["hops"] || opt["vertex"]
+                                || opt["srlg"] || opt["limit"] || opt["width"]
+                                || optStr.count("epsilon"))) {
+            throw std::runtime_error(
+                    "ERROR: -directed option is only compatible with options for the edge BDD and its evaluation.");
+        }
+
+        // Prune nodes whose probability mass is less than epsilon
+        double epsilon = 0.0;
+        double diverted = 0.0;
+        if (optStr.count("epsilon") && !optStr["epsilon"].empty()) {
+            epsilon = std::atof(optStr["epsilon"].c_str());
+        }
+
+        // Checked before the modes that do not build the edge BDD
+        if (opt["srlg"] && (opt["montecarlo"] || opt["allpairs"]
+                            || opt["expected"] || opt["states"]
+                            || opt["vertex"] || opt["limit"] || opt["topk"]
+                            || opt["sample"] || opt["evidence"]
+                            || opt["curve"] || opt["mttf"] || epsilon > 0.0
+                            || opt["width"])) {
+            throw std::runtime_error(
+                    "ERROR: -srlg option is only compatible with options for the edge BDD and its evaluation.");
+        }
+
+        // Hop limits are checked by their own spec instead of FBS
+        if (opt["hops"] && (opt["montecarlo"] || opt["allpairs"]
+                            || opt["expected"] || opt["states"]
+                            || opt["vertex"] || opt["srlg"] || opt["limit"]
+                            || epsilon > 0.0 || opt["width"])) {
+            throw std::runtime_error(
+                    "ERROR: -hops option is only compatible with options for the edge BDD and its evaluation.");
+        }
+
+        if (opt["demand"] && (opt["montecarlo"] || opt["allpairs"]
+                              || opt["expected"] || opt["states"]
+                              || opt["vertex"] || opt["srlg"] || opt["hops"]
+                              || opt["directed"] || epsilon > 0.0
+                              || opt["width"])) {
+            throw std::runtime_error(
+                    "ERROR: -demand option is only compatible with options for the edge BDD and its evaluation.");
+        }
+
+        if (opt["montecarlo"]) {
+            if (opt["vertex"]) throw std::runtime_error(
+                    "ERROR: -montecarlo option is not compatible with -vertex option.");
+            runMonteCarlo(graph, edge_prob_list, mh);
+            mh.end("finished");
+            return 0;
+        }
+
+        if (opt["allpairs"]) {
+            if (opt["vertex"]) throw std::runtime_error(
+                    "ERROR: -allpairs option is not compatible with -vertex option.");
+            runAllPairs(graph, edge_prob_list, mh);
+            mh.end("finished");
+            return 0;
+        }
+
+        if (opt["expected"]) {
+            if (opt["vertex"] || opt["hops"] || opt["srlg"] || opt["demand"]
+                || opt["limit"]) {
+                throw std::runtime_error(
+                        "ERROR: -expected option is not compatible with -vertex, -hops, -srlg, -demand and -limit options.");
+            }
+            runExpectedSites(graph, edge_prob_list, termFileName, mh);
+            mh.end("finished");
+            return 0;
+        }
+
+        if (opt["states"]) {
+            if (opt["vertex"]) throw std::runtime_error(
+                    "ERROR: -states option is not compatible with -vertex option.");
+            runMultiState(graph, mh);
+            mh.end("finished");
+            return 0;
+        }
+
         if (!opt["quiet"]) {
             mh << "---------- Edge reliability BDD construction start\n";
         }
@@ -384,41 +1028,240 @@ int main(int argc, char *argv[]) {
         FrontierBasedSearch fbs(graph, -1, false, false);
         DdStructure<2> dd;
 
-        dd = DdStructure<2>(fbs);
+        std::vector<double> edge_prob_rev_list(edge_prob_list.rbegin(), edge_prob_list.rend());
+        edge_prob_rev_list.insert(edge_prob_rev_list.begin(), 0.0); // Add a dummy probability for the root node
+
+        DdBuildOption buildOption;
+        if (opt["limit"]) buildOption.maxSize = optNum["limit"];
+        DdProfile profile;
+        if (opt["profile"]) buildOption.profile = &profile;
+
+        if ((epsilon > 0.0 || opt["width"]) && opt["vertex"]) {
+            throw std::runtime_error(
+                    "ERROR: --epsilon and -width options are not compatible with -vertex option.");
+        }
+
+        // Shared-risk link groups add a variable for each group
+        std::vector<std::vector<int> > groups;
+        std::vector<double> group_prob_list;
+        int numVars = graph.edgeSize();
+        if (opt["srlg"]) {
+            readGroups(optStr["srlg"], graph.edgeSize(), groups, group_prob_list);
+        }
+
+        // Limit the width; the restricted DD gives a lower bound and
+        // the relaxed DD gives an upper bound
+        if (opt["width"]) buildOption.maxWidth = optNum["width"];
+        bool const bounded = epsilon > 0.0 || opt["width"];
+        double upper = 1.0;
+
+        // Reuse the DD of an earlier run on the same topology; the bounded
+        // DDs depend on the probabilities and are not cached
+        bool const caching = optStr.count("cache") && !optStr["cache"].empty()
+                && !bounded && !opt["profile"];
+        uint64_t const cacheBytes = optStr.count("cachesize") ?
+                uint64_t(std::max(std::atof(optStr["cachesize"].c_str()), 0.0)
+                         * (1 << 20)) : uint64_t(1) << 30;
+
+        phaseStart = getWallClockTime();
+        try {
+            bool cached = false;
+            std::string cacheKey;
+            if (caching) {
+                cacheKey = DdCache::key(graph,
+                        cacheSpec(graph, termFileName, groups));
+                try {
+                    DdCache cache(optStr["cache"], cacheBytes);
+                    MessageHandler mhc;
+                    mhc.begin("loading") << " \"" << cache.path(cacheKey) << "\" ...";
+                    cached = cache.load(cacheKey, dd);
+                    mhc.end(cached ? "done" : "not found");
+                }
+                catch (std::runtime_error& e) {
+                    mh << "WARNING: " << e.what() << "; the cache is not used\n";
+                }
+                if (cached && opt["limit"]
+                        && dd.size() > size_t(optNum["limit"])) {
+                    throw DdSizeLimitExceeded(dd.size());
+                }
+            }
+
+            if (bounded) {
+                MassPruning<FrontierBasedSearch> pruning(fbs,
+                        edge_prob_rev_list, epsilon, &diverted);
+                dd = DdStructure<2>(pruning, buildOption);
+
+                if (!opt["width"]) {
+                    upper = dd.evaluate(ProbEval(edge_prob_rev_list)) + diverted;
+                }
+                else {
+                    double relaxedDiverted = 0.0;
+                    MassPruning<FrontierBasedSearch> relaxing(fbs,
+                            edge_prob_rev_list, epsilon, &relaxedDiverted);
+                    DdBuildOption relaxedOption = buildOption;
+                    relaxedOption.relaxed = true;
+                    relaxedOption.profile = 0;
+                    DdStructure<2> relaxedDd(relaxing, relaxedOption);
+                    upper = relaxedDd.evaluate(ProbEval(edge_prob_rev_list))
+                            + relaxedDiverted;
+                }
+                upper = std::min(upper, 1.0);
+            }
+            else if (opt["srlg"]) {
+                SharedRiskGroups<FrontierBasedSearch> srlg(fbs,
+                        graph.edgeSize(), groups);
+                edge_prob_rev_list = srlg.levelProbabilities(edge_prob_list,
+                        group_prob_list);
+                numVars = srlg.numVars();
+                if (!cached) dd = DdStructure<2>(srlg, buildOption);
+            }
+            else if (cached) {
+                // loaded from the cache
+            }
+            else if (opt["hops"]) {
+                HopConstrainedConnectivity hop(graph, optNum["hops"],
+                        readSourceTerminal(graph, termFileName));
+                dd = DdStructure<2>(hop, buildOption);
+            }
+            else if (opt["directed"]) {
+                DirectedReachability reach(graph,
+                        readSourceTerminal(graph, termFileName));
+                dd = DdStructure<2>(reach, buildOption);
+            }
+            else if (opt["demand"]) {
+                std::vector<int> sites = readTerminals(graph, termFileName);
+                if (sites.size() != 2 || graph.numColor() != 1) {
+                    throw std::runtime_error(
+                            "ERROR: -demand option needs exactly two terminals.");
+                }
+                std::vector<int> capacity = opt["capacity"] ?
+                        readCapacities(optStr["capacity"], graph.edgeSize()) :
+                        std::vector<int>(graph.edgeSize(), 1);
+                TwoTerminalFlow flow(graph, sites[0], sites[1],
+                        optNum["demand"], capacity);
+                dd = DdStructure<2>(flow, buildOption);
+            }
+            else {
+                dd = DdStructure<2>(fbs, buildOption);
+            }
+
+            // The cache only saves time; a failure to store is not fatal
+            if (caching && !cached) {
+                try {
+                    DdCache(optStr["cache"], cacheBytes).store(cacheKey, dd);
+                }
+                catch (std::runtime_error& e) {
+                    mh << "WARNING: " << e.what() << "; the DD is not cached\n";
+                }
+            }
+        }
+        catch (DdSizeLimitExceeded& e) {
+            if (opt["profile"]) writeProfile(profile, optStr["profile"]);
+            if (opt["vertex"]) throw std::runtime_error(
+                    "ERROR: #node exceeds the limit; Monte Carlo does not support -vertex option.");
+            if (opt["demand"]) throw std::runtime_error(
+                    "ERROR: #node exceeds the limit; Monte Carlo does not support -demand option.");
+            if (!opt["quiet"]) {
+                mh << "#node = " << e.size() << " exceeds the limit; "
+                   << "falling back to Monte Carlo\n";
+            }
+            runMonteCarlo(graph, edge_prob_list, mh);
+            mh.end("finished");
+            return 0;
+        }
+
+        report.buildTime = getWallClockTime() - phaseStart;
+        report.nodes = dd.size();
 
         if (!opt["quiet"]) {
             mh << "---------- Edge reliability BDD construction end\n";
         }
 
-        std::vector<double> edge_prob_rev_list(edge_prob_list.rbegin(), edge_prob_list.rend());
-        edge_prob_rev_list.insert(edge_prob_rev_list.begin(), 0.0); // Add a dummy probability for the root node
-        
+        if (opt["profile"]) writeProfile(profile, optStr["profile"]);
+
+        int const repeat = opt["repeat"] ? std::max(optNum["repeat"], 1) : 1;
+        if (opt["flat"] && FlatDdStructure<2>::fits(dd)) {
+            FlatDdStructure<2> fdd(dd, opt["threads"]);
+            MyVector<double> work;
+            phaseStart = getWallClockTime();
+            for (int r = 0; r < repeat; ++r) {
+                report.prob = fdd.evaluate(ProbEval(edge_prob_rev_list), work);
+            }
+            report.evalTime = (getWallClockTime() - phaseStart) / repeat;
+        }
+        else if (opt["compact"] && CompactDdStructure<2>::fits(dd)) {
+            CompactDdStructure<2> cdd(dd);
+            phaseStart = getWallClockTime();
+            for (int r = 0; r < repeat; ++r) {
+                report.prob = cdd.evaluate(ProbEval(edge_prob_rev_list));
+            }
+            report.evalTime = (getWallClockTime() - phaseStart) / repeat;
+        }
+        else {
+            phaseStart = getWallClockTime();
+            for (int r = 0; r < repeat; ++r) {
+                report.prob = dd.evaluate(ProbEval(edge_prob_rev_list));
+            }
+            report.evalTime = (getWallClockTime() - phaseStart) / repeat;
+        }
+
         if (!opt["quiet"]) {
             mh << "\n#node = " << dd.size() << ", #solution = "
                     << std::setprecision(10)
-                    << dd.evaluate(BddCardinality<double>(graph.edgeSize()))
-                    << ", prob = "
-                    << dd.evaluate(ProbEval(edge_prob_rev_list))
+                    << dd.evaluate(BddCardinality<double>(numVars))
+                    << ", prob = " << report.prob
                     << "\n";
+            if (bounded) {
+                mh << "prob in [" << report.prob << ", " << upper << "]";
+                if (epsilon > 0.0) mh << ", diverted = " << diverted;
+                mh << "\n";
+            }
         }
 
         if (opt["reduce"]) {
+            phaseStart = getWallClockTime();
+            dd.useMultiProcessors(opt["threads"]);
             dd.bddReduce();
+            report.reduceTime = getWallClockTime() - phaseStart;
+            report.reducedNodes = dd.size();
             if (!opt["quiet"]) {
                 mh << "\n#node = " << dd.size() << ", #solution = "
                    << std::setprecision(10)
-                   << dd.evaluate(BddCardinality<double>(graph.edgeSize()))
+                   << dd.evaluate(BddCardinality<double>(numVars))
                    << ", prob = "
                    << dd.evaluate(ProbEval(edge_prob_rev_list))
                    << "\n";
             }
         }
 
+        // Reliability over time with availability exp(-rate * t)
+        std::vector<double> edge_rate_list;
+        std::vector<double> curveTimes, edgeCurve, vertexCurve;
+        if (opt["curve"] || opt["mttf"]) {
+            if (!opt["rates"]) throw std::runtime_error(
+                    "ERROR: -curve and -mttf options need -rates option.");
+            edge_rate_list = readRates(optStr["rates"], graph.edgeSize());
+            curveTimes = parseTimeGrid(optStr.count("times") ?
+                    optStr["times"] : std::string());
+
+            std::vector<double> rateByLevel(edge_rate_list.rbegin(),
+                                            edge_rate_list.rend());
+            rateByLevel.insert(rateByLevel.begin(), 0.0);
+            edgeCurve = ReliabilityCurve(rateByLevel).evaluate(dd, curveTimes);
+
+            if (opt["mttf"] && !opt["quiet"]) {
+                mh << "\nMTTF = " << std::setprecision(10)
+                   << ReliabilityCurve::integrate(curveTimes, edgeCurve)
+                   << " (integrated over [" << curveTimes.front() << ", "
+                   << curveTimes.back() << "])\n";
+            }
+        }
+
         if (opt["count"]) {
             MessageHandler mh;
             if (!opt["quiet"]) {
                 mh.begin("counting solutions") << " ...";
-                mh << "\n#solution = " << dd.evaluate(BddCardinality<>(graph.edgeSize()));
+                mh << "\n#solution = " << dd.evaluate(BddCardinality<>(numVars));
                 mh.end();
             }
         }
@@ -453,14 +1296,43 @@ int main(int argc, char *argv[]) {
             BDD vertex_dd_s = BDD_ID(bddcopy(vertex_dd));
             tdzdd::SapporoBdd sapporo_bdd(vertex_dd_s);
             tdzdd::DdStructure<2> vertex_dd_structure = tdzdd::DdStructure<2>(sapporo_bdd);
+            report.vertexTime = execution_time;
+            report.vertexNodes = bddsize(vertex_dd);
+            report.vertexProb = vertex_dd_structure.evaluate(ProbEval(gv.edge_vertex_prob_list));
 
             if (!opt["quiet"]) {
                 mh << "Vertex reliability BDD construction time = " << execution_time << "\n";
-                mh << "\n#node = " << bddsize(vertex_dd)
-                   << ", prob = " << vertex_dd_structure.evaluate(ProbEval(gv.edge_vertex_prob_list))
+                mh << "\n#node = " << report.vertexNodes
+                   << ", prob = " << report.vertexProb
                    << "\n";
             }
 
+            if (!curveTimes.empty()) {
+                std::map<std::string, double> vertex_rate_map;
+                if (optStr.count("vertexrates") && !optStr["vertexrates"].empty()) {
+                    parse_vertex_prob_file(optStr["vertexrates"], vertex_rate_map);
+                }
+                std::vector<double> rateByLevel(gv.edge_vertex_prob_list.size(), 0.0);
+                for (int v = 1; v <= graph.vertexSize(); ++v) {
+                    std::map<std::string, double>::const_iterator it =
+                            vertex_rate_map.find(graph.vertexName(v));
+                    if (it != vertex_rate_map.end()) {
+                        rateByLevel[gv.v_list[v]] = it->second;
+                    }
+                }
+                for (int i = 0; i < graph.edgeSize(); ++i) {
+                    rateByLevel[gv.e_list[i]] = edge_rate_list[i];
+                }
+                vertexCurve = ReliabilityCurve(rateByLevel)
+                        .evaluate(vertex_dd_structure, curveTimes);
+
+                if (opt["mttf"] && !opt["quiet"]) {
+                    mh << "vertex MTTF = " << std::setprecision(10)
+                       << ReliabilityCurve::integrate(curveTimes, vertexCurve)
+                       << "\n";
+                }
+            }
+
             if (opt["alg_k"]) {
                 if (!opt["quiet"]) {
                     mh << "---------- alg_k start\n";
@@ -469,9 +1341,10 @@ int main(int argc, char *argv[]) {
                 // Run Kuo et al.'s algorithm
                 bddp h = alg_k(gv.shifted_edge_dd.GetID(), graph, graph.edgeSize(), graph.vertexSize(), gv.e_list, gv.v_list);
                 auto alg_k_end = std::chrono::high_resolution_clock::now();
+                double alg_k_time = std::chrono::duration_cast<std::chrono::milliseconds>(alg_k_end - alg_k_start).count() / 1000.0;
+                report.algkTime = alg_k_time;
                 if (!opt["quiet"]) {
                     mh << "---------- alg_k end\n";
-                    double alg_k_time = std::chrono::duration_cast<std::chrono::milliseconds>(alg_k_end - alg_k_start).count() / 1000.0;
                     mh << "alg_k execution time = " << alg_k_time << " seconds\n";
                 }
                 
@@ -505,6 +1378,95 @@ int main(int argc, char *argv[]) {
                 if (--count == 0) break;
             }
         }
+
+        if (opt["topk"]) {
+            if (!FlatDdStructure<2>::fits(dd)) throw std::runtime_error(
+                    "ERROR: the BDD is too large for -topk option.");
+            FlatDdStructure<2> fdd(dd);
+            TopKConfigurations topk(fdd, edge_prob_rev_list,
+                                    opt["topk_connected"]);
+            TopKConfigurations::Configuration c;
+            int const m = graph.edgeSize();
+
+            std::cout << "# rank probability failed_edges\n";
+            for (int k = 1; k <= optNum["topk"] && topk.next(c); ++k) {
+                std::cout << k << " " << std::setprecision(10) << c.prob;
+                for (size_t t = 0; t < c.zeros.size(); ++t) {
+                    std::cout << " " << m - c.zeros[t] + 1;
+                }
+                std::cout << "\n";
+            }
+        }
+
+        if (opt["sample"]) {
+            if (!FlatDdStructure<2>::fits(dd)) throw std::runtime_error(
+                    "ERROR: the BDD is too large for -sample option.");
+            FlatDdStructure<2> fdd(dd);
+            ConditionedSampler sampler(fdd, edge_prob_rev_list,
+                                       !opt["sample_disconnected"]);
+            std::vector<std::vector<char> > samples(optNum["sample"]);
+            uint64_t seed = opt["seed"] ? optNum["seed"] : 1;
+            sampler.sampleBatch(samples, seed);
+            int const m = graph.edgeSize();
+
+            std::string line(m, '0');
+            for (size_t s = 0; s < samples.size(); ++s) {
+                for (int a = 0; a < m; ++a) {
+                    line[a] = samples[s][m - a] ? '1' : '0';
+                }
+                std::cout << line << "\n";
+            }
+        }
+
+        if (opt["evidence"]) {
+            if (!FlatDdStructure<2>::fits(dd)) throw std::runtime_error(
+                    "ERROR: the BDD is too large for -evidence option.");
+            FlatDdStructure<2> fdd(dd);
+            ConditionalReliability cr(fdd, edge_prob_rev_list);
+            int const m = graph.edgeSize();
+
+            std::ifstream ifs;
+            std::string const& fileName = optStr["evidence"];
+            if (fileName != "-") {
+                ifs.open(fileName.c_str());
+                if (!ifs) throw std::runtime_error("ERROR: cannot open " + fileName);
+            }
+            std::istream& is = fileName == "-" ? std::cin : ifs;
+
+            std::string line;
+            std::vector<ConditionalReliability::Evidence> evidence;
+            int queries = 0;
+            double queryTime = 0.0;
+            while (std::getline(is, line)) {
+                std::istringstream iss(line);
+                int e;
+                evidence.clear();
+                while (iss >> e) {
+                    if (e == 0 || m < std::abs(e)) throw std::runtime_error(
+                            "ERROR: no such edge in evidence: " + line);
+                    evidence.push_back(ConditionalReliability::Evidence(
+                            m - std::abs(e) + 1, e > 0));
+                }
+                double start = getWallClockTime();
+                double r = cr.query(evidence);
+                queryTime += getWallClockTime() - start;
+                ++queries;
+                std::cout << std::setprecision(10) << r << std::endl;
+            }
+            if (!opt["quiet"] && queries > 0) {
+                mh << "\n#query = " << queries << ", mean query time = "
+                   << queryTime / queries << "\n";
+            }
+        }
+
+        if (opt["curve"]) {
+            writeCurve(optStr["curve"], curveTimes, edgeCurve, vertexCurve);
+        }
+
+        if (opt["csv"]) {
+            report.maxrss = ResourceUsage().maxrss;
+            report.appendCsv(optStr["csv"]);
+        }
     }
     catch (std::exception& e) {
         std::cerr << e.what() << "\n";
@@ -0,0 +1,109 @@
+/*
+ * C interface of libreliability.
+ *
+ * A graph is made from an array of edges between integer vertex ids, and
+ * its edge BDD is built once or loaded from a file.  The BDD is then
+ * evaluated with probability arrays owned by the caller, which are read
+ * in place.  Edges are numbered from 0 in the order of their first
+ * appearance; repeated edges are ignored.
+ *
+ * Functions returning int return 0 on success and -1 on failure, and
+ * functions returning a pointer return NULL on failure; rel_last_error()
+ * then describes the failure.  Different handles may be used on different
+ * threads, and a BDD may be evaluated on several threads at once, except
+ * for rel_vertex_reliability(), which uses the global state of the
+ * SAPPORO BDD package.
+ */
+
+#ifndef RELIABILITY_H
+#define RELIABILITY_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct rel_graph rel_graph;
+typedef struct rel_dd rel_dd;
+
+/**
+ * Creates a graph.
+ * @param num_edges the number of edges.
+ * @param edges the end points of edge i at edges[2*i] and edges[2*i+1].
+ * @param num_terminals the number of terminals; 0 to make all vertices
+ *        terminals.
+ * @param terminals the vertex ids of the terminals.
+ * @return the graph.
+ */
+rel_graph* rel_graph_create(int num_edges, int const* edges,
+                            int num_terminals, int const* terminals);
+
+/**
+ * Gets the number of distinct edges, which is the length of the edge
+ * probability arrays.
+ */
+int rel_graph_num_edges(rel_graph const* graph);
+
+/**
+ * Gets the number of vertices.
+ */
+int rel_graph_num_vertices(rel_graph const* graph);
+
+void rel_graph_free(rel_graph* graph);
+
+/**
+ * Builds the BDD of the edge sets connecting the terminals.
+ * @param graph the graph, which must outlive the BDD.
+ * @return the BDD.
+ */
+rel_dd* rel_dd_build(rel_graph const* graph);
+
+/**
+ * Loads a BDD saved by rel_dd_save() for the same graph.
+ * @param graph the graph, which must outlive the BDD.
+ * @param path the file name.
+ * @return the BDD.
+ */
+rel_dd* rel_dd_load(rel_graph const* graph, char const* path);
+
+int rel_dd_save(rel_dd const* dd, char const* path);
+
+/**
+ * Gets the number of nonterminal nodes.
+ */
+size_t rel_dd_size(rel_dd const* dd);
+
+/**
+ * Computes the probability that the terminals are connected.
+ * @param dd the BDD.
+ * @param edge_probs the probability that edge i works at edge_probs[i].
+ * @param result receives the probability.
+ */
+int rel_dd_evaluate(rel_dd const* dd, double const* edge_probs,
+                    double* result);
+
+/**
+ * Computes the probability that the terminals are connected when both
+ * edges and vertices may fail.
+ * @param dd the BDD.
+ * @param edge_probs the probability that edge i works at edge_probs[i].
+ * @param vertex_probs the probability that vertex v works at
+ *        vertex_probs[v] for every vertex id v.
+ * @param result receives the probability.
+ */
+int rel_vertex_reliability(rel_dd const* dd, double const* edge_probs,
+                           double const* vertex_probs, double* result);
+
+void rel_dd_free(rel_dd* dd);
+
+/**
+ * Gets the message of the last failure on the calling thread.
+ */
+char const* rel_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RELIABILITY_H */
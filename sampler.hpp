@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "tdzdd/FlatDdStructure.hpp"
+#include "tdzdd/util/MyVector.hpp"
+#include "probability.hpp"
+
+/**
+ * Exact sampler of assignments conditioned on reaching one terminal of a
+ * BDD.
+ *
+ * Each level is a variable that takes 1 with the given probability.
+ * One bottom-up pass computes the probability of reaching the terminal
+ * from each node.  A sample then walks down from the root and takes each
+ * branch with probability proportional to the branch probability times
+ * the probability of its child, which draws the assignment from the exact
+ * conditional distribution in O(levels) time without rejection.  Levels
+ * skipped by an edge of the BDD do not affect the terminal and are drawn
+ * from their own probabilities.
+ */
+class ConditionedSampler {
+public:
+    typedef uint32_t Index;
+    typedef tdzdd::FlatDdStructure<2> Diagram;
+
+private:
+    static int const BLOCK_SIZE = 256;
+
+    Diagram const& dd;
+    std::vector<double> const prob;
+    tdzdd::MyVector<double> reach;
+
+public:
+    /**
+     * Constructor.
+     * @param dd the BDD.
+     * @param prob probability of taking 1 at each level; index 0 is unused.
+     * @param target the terminal to be reached.
+     */
+    ConditionedSampler(Diagram const& dd, std::vector<double> const& prob,
+                       bool target = true)
+            : dd(dd), prob(prob) {
+        dd.evaluate(ProbEval(prob, target), reach);
+    }
+
+    /**
+     * Gets the probability of the condition.
+     * @return the probability of reaching the terminal.
+     */
+    double probability() const {
+        return reach[dd.root()];
+    }
+
+    /**
+     * Draws one assignment.
+     * @param rng random number generator.
+     * @param value value[i] receives the value of level i; index 0 is unused.
+     * @exception std::runtime_error the condition has probability zero.
+     */
+    template<typename RNG>
+    void sample(RNG& rng, std::vector<char>& value) const {
+        if (probability() <= 0.0) throw std::runtime_error(
+                "ConditionedSampler: the condition has probability zero");
+
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        int const n = prob.size() - 1;
+        value.resize(n + 1);
+        value[0] = 0;
+        Index f = dd.root();
+
+        for (int i = n; i > 0; --i) {
+            if (dd.level(f) < i) {
+                value[i] = uniform(rng) < prob[i];
+                continue;
+            }
+
+            Index const f0 = dd.child(f, 0);
+            Index const f1 = dd.child(f, 1);
+            double const w0 = (1 - prob[i]) * reach[f0];
+            double const w1 = prob[i] * reach[f1];
+            bool const b = uniform(rng) * (w0 + w1) < w1;
+            value[i] = b;
+            f = b ? f1 : f0;
+        }
+    }
+
+    /**
+     * Draws assignments in parallel.
+     * The result depends only on the number of samples and @p seed, not on
+     * the number of threads.
+     * @param samples samples[s] receives the s-th assignment.
+     * @param seed seed of the random number generator.
+     */
+    void sampleBatch(std::vector<std::vector<char> >& samples,
+                     uint64_t seed) const {
+        intmax_t const n = samples.size();
+        intmax_t const blocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        if (probability() <= 0.0) throw std::runtime_error(
+                "ConditionedSampler: the condition has probability zero");
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (intmax_t k = 0; k < blocks; ++k) {
+            std::mt19937_64 rng(streamSeed(seed, k));
+            intmax_t const end = std::min(n, (k + 1) * BLOCK_SIZE);
+            for (intmax_t s = k * BLOCK_SIZE; s < end; ++s) {
+                sample(rng, samples[s]);
+            }
+        }
+    }
+};
@@ -0,0 +1,277 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <stdint.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "DdEval.hpp"
+#include "DdStructure.hpp"
+#include "dd/DataTable.hpp"
+#include "util/demangle.hpp"
+#include "util/MessageHandler.hpp"
+#include "util/MyVector.hpp"
+
+namespace tdzdd {
+
+/**
+ * Read-only DD with 32-bit node references.
+ * All nodes are numbered consecutively from the 0-terminal, the 1-terminal
+ * and then the nodes at level 1, 2, ..., and each branch holds the number
+ * of its child instead of a 64-bit NodeId.
+ * The level of a node is found by binary search on the table of the first
+ * number at each level.
+ * A binary node occupies 8 bytes instead of 16 bytes, which halves the
+ * memory traffic of evaluation.
+ * @tparam ARITY arity of the nodes.
+ */
+template<int ARITY>
+class CompactDdStructure {
+public:
+    typedef uint32_t Index; ///< Node number.
+
+    /**
+     * Node with 32-bit branches.
+     */
+    struct Node {
+        Index branch[ARITY];
+    };
+
+private:
+    MyVector<Node> nodes;           ///< All nodes but the terminals.
+    MyVector<size_t> levelOffset;   ///< The first node number at each level.
+    MyVector<MyVector<int> > lowerLevels; ///< Levels freed after each level.
+    Index root_;
+    int topLevel_;
+    bool useMP;
+
+public:
+    /**
+     * Checks if a DD can be converted.
+     * @param dd the DD.
+     * @return true if all nodes can be numbered in 32 bits.
+     */
+    static bool fits(DdStructure<ARITY> const& dd) {
+        return dd.size() + 2 <= size_t(UINT32_MAX);
+    }
+
+    /**
+     * Converts a DD.
+     * @param dd the DD.
+     * @param useMP use algorithms for multiple processors.
+     * @exception std::overflow_error the DD does not fit in 32 bits.
+     */
+    explicit CompactDdStructure(DdStructure<ARITY> const& dd, bool useMP =
+            false) :
+            useMP(useMP) {
+        if (!fits(dd)) throw std::overflow_error(
+                "CompactDdStructure: too many nodes");
+
+        NodeTableEntity<ARITY> const& diagram = *dd.getDiagram();
+        NodeId const root = dd.root();
+        topLevel_ = root.row();
+
+        levelOffset.resize(topLevel_ + 2);
+        levelOffset[0] = 0;
+        levelOffset[1] = 2;
+        for (int i = 1; i <= topLevel_; ++i) {
+            levelOffset[i + 1] = levelOffset[i] + diagram[i].size();
+        }
+
+        nodes.resize(levelOffset[topLevel_ + 1] - 2);
+        lowerLevels.resize(topLevel_ + 1);
+
+        for (int i = 1; i <= topLevel_; ++i) {
+            MyVector<tdzdd::Node<ARITY> > const& row = diagram[i];
+            Node* const q = nodes.data() + (levelOffset[i] - 2);
+
+            for (size_t j = 0; j < row.size(); ++j) {
+                for (int b = 0; b < ARITY; ++b) {
+                    NodeId f = row[j].branch[b];
+                    q[j].branch[b] = Index(levelOffset[f.row()] + f.col());
+                }
+            }
+
+            lowerLevels[i] = diagram.lowerLevels(i);
+        }
+
+        root_ = Index(levelOffset[root.row()] + root.col());
+    }
+
+    /**
+     * Gets the root node number.
+     * @return the root node number.
+     */
+    Index root() const {
+        return root_;
+    }
+
+    /**
+     * Gets the level of the root node.
+     * @return the top level.
+     */
+    int topLevel() const {
+        return topLevel_;
+    }
+
+    /**
+     * Gets the number of nonterminal nodes.
+     * @return the number of nonterminal nodes.
+     */
+    size_t size() const {
+        return nodes.size();
+    }
+
+    /**
+     * Gets the level of a node.
+     * @param f node number.
+     * @return the level; 0 for the terminals.
+     */
+    int level(Index f) const {
+        return int(std::upper_bound(levelOffset.begin(),
+                levelOffset.begin() + topLevel_ + 2, size_t(f))
+                - levelOffset.begin()) - 1;
+    }
+
+    /**
+     * Gets a child node number.
+     * @param f node number of a nonterminal node.
+     * @param b branch index.
+     * @return the child node number.
+     */
+    Index child(Index f, int b) const {
+        assert(f >= 2);
+        return nodes[f - 2].branch[b];
+    }
+
+    /**
+     * Evaluates the DD from the bottom to the top.
+     * @param evaluator the driver class that implements DdEval interface.
+     * @return value at the root.
+     */
+    template<typename S, typename T, typename R>
+    R evaluate(DdEval<S,T,R> const& evaluator) const {
+        S eval(evaluator.entity()); // copied
+#ifdef _OPENMP
+        bool useMP = this->useMP && eval.isThreadSafe();
+#endif
+        bool msg = eval.showMessages();
+        int const n = topLevel_;
+
+        MessageHandler mh;
+        if (msg) {
+            mh.begin(typenameof(eval));
+            mh.setSteps(n);
+        }
+
+#ifdef _OPENMP
+        int threads = useMP ? omp_get_max_threads() : 0;
+        MyVector<S> evals(threads, eval);
+#endif
+        eval.initialize(n);
+#ifdef _OPENMP
+        if (useMP)
+#pragma omp parallel
+        {
+            evals[omp_get_thread_num()].initialize(n);
+        }
+#endif
+
+        DataTable<T> work(n + 1);
+        work[0].resize(2);
+        for (int j = 0; j < 2; ++j) {
+            eval.evalTerminal(work[0][j], j);
+        }
+
+        for (int i = 1; i <= n; ++i) {
+            size_t const base = levelOffset[i];
+            size_t const m = levelOffset[i + 1] - base;
+            Node const* const node = nodes.data() + (base - 2);
+            work[i].resize(m);
+
+#ifdef _OPENMP
+            if (useMP)
+#pragma omp parallel
+            {
+                int k = omp_get_thread_num();
+
+#pragma omp for schedule(static)
+                for (intmax_t j = 0; j < intmax_t(m); ++j) {
+                    evalNode(evals[k], work, i, node[j], work[i][j]);
+                }
+            }
+            else
+#endif
+            for (size_t j = 0; j < m; ++j) {
+                evalNode(eval, work, i, node[j], work[i][j]);
+            }
+
+            MyVector<int> const& levels = lowerLevels[i];
+            for (int const* t = levels.begin(); t != levels.end(); ++t) {
+                work[*t].clear();
+                eval.destructLevel(*t);
+            }
+#ifdef _OPENMP
+            if (useMP)
+#pragma omp parallel
+            {
+                int k = omp_get_thread_num();
+                for (int const* t = levels.begin(); t != levels.end(); ++t) {
+                    evals[k].destructLevel(*t);
+                }
+            }
+#endif
+            if (msg) mh.step();
+        }
+
+        int const r = level(root_);
+        R retval = eval.getValue(work[r][root_ - levelOffset[r]]);
+        if (msg) mh.end();
+        return retval;
+    }
+
+private:
+    template<typename S, typename T>
+    void evalNode(S& eval, DataTable<T>& work, int i, Node const& node,
+                  T& v) const {
+        DdValues<T,ARITY> values;
+        for (int b = 0; b < ARITY; ++b) {
+            Index f = node.branch[b];
+            // most children are on the next level or terminals
+            int ii = (f < 2) ? 0 : (f >= levelOffset[i - 1]) ? i - 1 : level(f);
+            values.setReference(b, work[ii][f - levelOffset[ii]]);
+            values.setLevel(b, ii);
+        }
+        eval.evalNode(v, i, values);
+    }
+};
+
+} // namespace tdzdd
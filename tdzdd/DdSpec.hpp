@@ -52,6 +52,7 @@ namespace tdzdd {
  *
  * Optionally, the following functions can be overloaded:
  * - void printLevel(std::ostream& os, int level) const
+ * - double priority(void const* p, int level) const
  *
  * A return code of get_root(void*) or get_child(void*, int, bool) is:
  * 0 when the node is the 0-terminal, -1 when it is the 1-terminal, or
@@ -81,6 +82,17 @@ public:
         os << level;
     }
 
+    /**
+     * Returns the priority of a state, used to select the nodes to keep
+     * when the width of each level is limited.
+     * @param p pointer to the state.
+     * @param level level of the node.
+     * @return the priority; larger is kept first.
+     */
+    double priority(void const* p, int level) const {
+        return 0;
+    }
+
     /**
      * Returns a random instance using simple depth-first search
      * without caching.
@@ -187,6 +199,7 @@ protected:
  *
  * Optionally, the following functions can be overloaded:
  * - void printLevel(std::ostream& os, int level) const
+ * - double priority(void const* p, int level) const
  *
  * @tparam S the class implementing this class.
  * @tparam AR arity of the nodes.
@@ -26,6 +26,8 @@
 
 #include "op/BinaryOperation.hpp"
 #include "op/Lookahead.hpp"
+#include "op/MassPruning.hpp"
+#include "op/SharedRiskGroups.hpp"
 #include "op/Unreduction.hpp"
 
 namespace tdzdd {
@@ -27,9 +27,11 @@
 #include <algorithm>
 #include <cassert>
 #include <climits>
+#include <istream>
 #include <ostream>
 #include <set>
 #include <stdexcept>
+#include <stdint.h>
 #include <vector>
 
 #include "DdEval.hpp"
@@ -45,6 +47,7 @@
 #include "util/MessageHandler.hpp"
 #include "util/MyHashTable.hpp"
 #include "util/MyVector.hpp"
+#include "util/ResourceUsage.hpp"
 
 namespace tdzdd {
 
@@ -111,18 +114,59 @@ public:
         construct_(spec.entity());
     }
 
+    /**
+     * DD construction with optional controls.
+     * @param spec DD spec.
+     * @param option construction controls.
+     * @param useMP use algorithms for multiple processors.
+     * The width limit and the profile are supported only by the
+     * single-threaded builder.
+     * @exception DdSizeLimitExceeded the number of nodes exceeds
+     *            @p option.maxSize.
+     */
+    template<typename SPEC>
+    DdStructure(DdSpecBase<SPEC,ARITY> const& spec,
+                DdBuildOption const& option, bool useMP = false) :
+            useMP(useMP) {
+#ifdef _OPENMP
+        if (useMP && option.maxWidth == 0 && option.profile == 0) {
+            constructMP_(spec.entity(), option);
+        }
+        else
+#endif
+        construct_(spec.entity(), option);
+    }
+
 private:
+    void checkSize(DdBuildOption const& option) const {
+        if (option.maxSize > 0 && size() > option.maxSize) {
+            throw DdSizeLimitExceeded(size());
+        }
+    }
+
     template<typename SPEC>
-    void construct_(SPEC const& spec) {
+    void construct_(SPEC const& spec,
+                    DdBuildOption const& option = DdBuildOption()) {
         MessageHandler mh;
         mh.begin(typenameof(spec));
         DdBuilder<SPEC> zc(spec, diagram);
+        zc.setMaxWidth(option.maxWidth, option.relaxed);
+        zc.setProfile(option.profile);
+        if (option.profile) option.profile->spec = typenameof(spec);
+        double const startTime = getWallClockTime();
         int n = zc.initialize(root_);
 
         if (n > 0) {
             mh.setSteps(n);
             for (int i = n; i > 0; --i) {
+                double const t = getWallClockTime();
                 zc.construct(i);
+                if (option.profile) {
+                    option.profile->levels.back().time = getWallClockTime() - t;
+                    option.profile->size = size();
+                    option.profile->time = getWallClockTime() - startTime;
+                }
+                checkSize(option);
                 mh.step();
             }
         }
@@ -130,11 +174,16 @@ private:
             mh << " ...";
         }
 
+        if (option.profile) {
+            option.profile->size = size();
+            option.profile->time = getWallClockTime() - startTime;
+        }
         mh.end(size());
     }
 
     template<typename SPEC>
-    void constructMP_(SPEC const& spec) {
+    void constructMP_(SPEC const& spec,
+                      DdBuildOption const& option = DdBuildOption()) {
         MessageHandler mh;
         mh.begin(typenameof(spec));
         DdBuilderMP<SPEC> zc(spec, diagram);
@@ -147,6 +196,7 @@ private:
             mh.setSteps(n);
             for (int i = n; i > 0; --i) {
                 zc.construct(i);
+                checkSize(option);
                 mh.step();
             }
         }
@@ -747,6 +797,71 @@ public:
         os << nodeId[root_.row()][root_.col()] << "\n";
         assert(k == l * 2);
     }
+
+    /**
+     * Writes the node table in a binary format of this machine.
+     * @param os the output stream opened in binary mode.
+     */
+    void writeBinary(std::ostream& os) const {
+        uint64_t header[4] = {BINARY_MAGIC, uint64_t(ARITY),
+                              uint64_t(diagram->numRows()), root_.code()};
+        os.write(reinterpret_cast<char const*>(header), sizeof(header));
+
+        for (int i = 1; i < diagram->numRows(); ++i) {
+            uint64_t const m = (*diagram)[i].size();
+            os.write(reinterpret_cast<char const*>(&m), sizeof(m));
+            os.write(reinterpret_cast<char const*>((*diagram)[i].data()),
+                     m * sizeof(Node<ARITY>));
+        }
+    }
+
+    /**
+     * Reads the node table written by writeBinary.
+     * @param is the input stream opened in binary mode.
+     * @exception std::runtime_error the data is broken.
+     */
+    void readBinary(std::istream& is) {
+        uint64_t header[4];
+        if (!is.read(reinterpret_cast<char*>(header), sizeof(header))
+                || header[0] != BINARY_MAGIC || header[1] != uint64_t(ARITY)
+                || header[2] < 1 || header[2] > NODE_ROW_MAX + 1) {
+            throw std::runtime_error("DdStructure: broken binary data");
+        }
+
+        int const n = header[2];
+        NodeTableEntity<ARITY>& table = diagram.init(n);
+        root_ = NodeId(header[3]);
+
+        for (int i = 1; i < n; ++i) {
+            uint64_t m;
+            if (!is.read(reinterpret_cast<char*>(&m), sizeof(m))
+                    || m > NODE_COL_MAX) {
+                throw std::runtime_error("DdStructure: broken binary data");
+            }
+            table.initRow(i, m);
+            if (!is.read(reinterpret_cast<char*>(table[i].data()),
+                         m * sizeof(Node<ARITY>))) {
+                throw std::runtime_error("DdStructure: broken binary data");
+            }
+
+            for (size_t j = 0; j < m; ++j) {
+                for (int b = 0; b < ARITY; ++b) {
+                    NodeId f = table[i][j].branch[b];
+                    if (f.row() >= i || f.col() >= table[f.row()].size()) {
+                        throw std::runtime_error(
+                                "DdStructure: broken binary data");
+                    }
+                }
+            }
+        }
+
+        if (root_.row() >= n || root_.col() >= table[root_.row()].size()) {
+            throw std::runtime_error("DdStructure: broken binary data");
+        }
+    }
+
+private:
+    static uint64_t const BINARY_MAGIC = 0x3130444444445a54ULL; // "TZDDDD01"
 };
 
 } // namespace tdzdd
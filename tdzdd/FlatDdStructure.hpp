@@ -0,0 +1,403 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "DdEval.hpp"
+#include "DdStructure.hpp"
+#include "util/demangle.hpp"
+#include "util/MessageHandler.hpp"
+#include "util/MyVector.hpp"
+
+namespace tdzdd {
+
+/**
+ * Frozen DD laid out for repeated bottom-up evaluation.
+ * Nodes are numbered from the bottom: 0 and 1 for the terminals, then the
+ * nodes at level 1, 2, ..., so that every child has a smaller number than
+ * its parent and the root is the last node.
+ * Each branch and the level are kept in separate arrays indexed by the node
+ * number, and evaluation fills one flat array of values in a single pass,
+ * prefetching the values of the children a few nodes ahead.
+ * @tparam ARITY arity of the nodes.
+ * @tparam Index integer type of node numbers.
+ */
+template<int ARITY, typename Index = uint32_t>
+class FlatDdStructure {
+    static int const PREFETCH_DISTANCE = 8;
+    static size_t const WIDE_NODES_PER_THREAD = 1024;
+    static size_t const CHUNK_SIZE = 8;
+
+    MyVector<Index> branch_[ARITY]; ///< Children of each node.
+    MyVector<int> level_;           ///< Level of each node.
+    MyVector<Index> levelOffset;    ///< The first node number at each level.
+    Index root_;
+    int topLevel_;
+    bool useMP;
+
+public:
+    /**
+     * Checks if a DD can be converted.
+     * @param dd the DD.
+     * @return true if all nodes can be numbered by Index.
+     */
+    static bool fits(DdStructure<ARITY> const& dd) {
+        return dd.size() + 2 <= size_t(Index(-1));
+    }
+
+    /**
+     * Converts a DD.
+     * @param dd the DD.
+     * @param useMP use algorithms for multiple processors.
+     * @exception std::overflow_error the DD does not fit in Index.
+     */
+    explicit FlatDdStructure(DdStructure<ARITY> const& dd, bool useMP = false) :
+            useMP(useMP) {
+        if (!fits(dd)) throw std::overflow_error(
+                "FlatDdStructure: too many nodes");
+
+        NodeTableEntity<ARITY> const& diagram = *dd.getDiagram();
+        NodeId const root = dd.root();
+        topLevel_ = root.row();
+
+        levelOffset.resize(topLevel_ + 2);
+        levelOffset[0] = 0;
+        levelOffset[1] = 2;
+        for (int i = 1; i <= topLevel_; ++i) {
+            levelOffset[i + 1] = levelOffset[i] + diagram[i].size();
+        }
+
+        size_t const total = levelOffset[topLevel_ + 1];
+        for (int b = 0; b < ARITY; ++b) {
+            branch_[b].resize(total);
+            branch_[b][0] = branch_[b][1] = 0;
+        }
+        level_.resize(total);
+        level_[0] = level_[1] = 0;
+
+        for (int i = 1; i <= topLevel_; ++i) {
+            MyVector<Node<ARITY> > const& row = diagram[i];
+            Index const base = levelOffset[i];
+
+            for (size_t j = 0; j < row.size(); ++j) {
+                for (int b = 0; b < ARITY; ++b) {
+                    NodeId f = row[j].branch[b];
+                    branch_[b][base + j] = levelOffset[f.row()] + f.col();
+                }
+                level_[base + j] = i;
+            }
+        }
+
+        root_ = Index(levelOffset[root.row()] + root.col());
+    }
+
+    /**
+     * Gets the number of nodes including the terminals.
+     * @return the number of nodes.
+     */
+    size_t numNodes() const {
+        return level_.size();
+    }
+
+    /**
+     * Gets the number of nonterminal nodes.
+     * @return the number of nonterminal nodes.
+     */
+    size_t size() const {
+        return level_.size() - 2;
+    }
+
+    /**
+     * Gets the root node number.
+     * @return the root node number.
+     */
+    Index root() const {
+        return root_;
+    }
+
+    /**
+     * Gets the level of the root node.
+     * @return the top level.
+     */
+    int topLevel() const {
+        return topLevel_;
+    }
+
+    /**
+     * Gets the level of a node.
+     * @param f node number.
+     * @return the level; 0 for the terminals.
+     */
+    int level(Index f) const {
+        return level_[f];
+    }
+
+    /**
+     * Gets a child node number.
+     * @param f node number of a nonterminal node.
+     * @param b branch index.
+     * @return the child node number.
+     */
+    Index child(Index f, int b) const {
+        return branch_[b][f];
+    }
+
+    /**
+     * Gets the first node number at a level.
+     * @param i the level.
+     * @return the first node number.
+     */
+    Index levelBegin(int i) const {
+        return i == 0 ? 0 : levelOffset[i];
+    }
+
+    /**
+     * Gets the node number next to the last one at a level.
+     * @param i the level.
+     * @return the node number next to the last one.
+     */
+    Index levelEnd(int i) const {
+        return i == 0 ? 2 : levelOffset[i + 1];
+    }
+
+    /**
+     * Evaluates the DD from the bottom to the top.
+     * @param evaluator the driver class that implements DdEval interface.
+     * @return value at the root.
+     */
+    template<typename S, typename T, typename R>
+    R evaluate(DdEval<S,T,R> const& evaluator) const {
+        MyVector<T> work;
+        return evaluate(evaluator, work);
+    }
+
+    /**
+     * Evaluates the DD from the bottom to the top, leaving the value of
+     * every node in a work array that can be reused by later evaluations.
+     * The values must not refer to storage owned by the evaluator.
+     * @param evaluator the driver class that implements DdEval interface.
+     * @param work the values indexed by node numbers.
+     * @return value at the root.
+     */
+    template<typename S, typename T, typename R>
+    R evaluate(DdEval<S,T,R> const& evaluator, MyVector<T>& work) const {
+        S eval(evaluator.entity()); // copied
+        bool msg = eval.showMessages();
+        int const n = topLevel_;
+#ifdef _OPENMP
+        bool const mp = useMP && eval.isThreadSafe()
+                && omp_get_max_threads() >= 2;
+#endif
+
+        MessageHandler mh;
+        if (msg) {
+            mh.begin(typenameof(eval));
+#ifdef _OPENMP
+            if (mp) mh << " " << omp_get_max_threads() << "x";
+#endif
+            mh.setSteps(n);
+        }
+
+#ifdef _OPENMP
+        MyVector<S> evals(mp ? omp_get_max_threads() : 0, eval);
+#endif
+        eval.initialize(n);
+        work.resize(numNodes());
+        eval.evalTerminal(work[0], 0);
+        eval.evalTerminal(work[1], 1);
+
+#ifdef _OPENMP
+        if (mp) {
+            evaluateMP(evals, work);
+        }
+        else
+#endif
+        for (int i = 1; i <= n; ++i) {
+            evaluateRange(eval, work, i, levelOffset[i], levelOffset[i + 1]);
+            if (msg) mh.step();
+        }
+
+        R retval = eval.getValue(work[root()]);
+        for (int i = 0; i <= n; ++i) {
+            eval.destructLevel(i);
+#ifdef _OPENMP
+            for (size_t k = 0; k < evals.size(); ++k) {
+                evals[k].destructLevel(i);
+            }
+#endif
+        }
+        if (msg) mh.end();
+        return retval;
+    }
+
+protected:
+    /**
+     * Evaluates the nodes in a range at one level.
+     * @param eval the evaluator.
+     * @param work the values indexed by node numbers.
+     * @param i the level.
+     * @param from the first node number.
+     * @param to the node number next to the last one.
+     */
+    template<typename S, typename T>
+    void evaluateRange(S& eval, MyVector<T>& work, int i, Index from,
+                       Index to) const {
+        T* const w = work.data();
+        Index const* br[ARITY];
+        for (int b = 0; b < ARITY; ++b) {
+            br[b] = branch_[b].data();
+        }
+        int const* const lv = level_.data();
+
+        for (Index f = from; f < to; ++f) {
+#ifdef __GNUC__
+            if (f + PREFETCH_DISTANCE < to) {
+                for (int b = 0; b < ARITY; ++b) {
+                    __builtin_prefetch(w + br[b][f + PREFETCH_DISTANCE]);
+                }
+            }
+#endif
+            DdValues<T,ARITY> values;
+            for (int b = 0; b < ARITY; ++b) {
+                Index g = br[b][f];
+                values.setReference(b, w[g]);
+                values.setLevel(b, lv[g]);
+            }
+            eval.evalNode(w[f], i, values);
+        }
+    }
+
+#ifdef _OPENMP
+    /**
+     * Consecutive levels evaluated together.
+     */
+    struct Segment {
+        Index from; ///< The first node number.
+        Index to;   ///< The node number next to the last one.
+        int level;  ///< The level of a wide segment.
+        bool wide;  ///< Whether the nodes are shared out evenly.
+    };
+
+    /**
+     * Evaluates all nonterminal nodes by a single team of threads.
+     * A level with enough nodes for all threads is shared out evenly and
+     * followed by a barrier.  Consecutive narrower levels are merged into
+     * one segment where threads take small chunks of nodes in increasing
+     * order and wait only for the children of each node, so that a tall
+     * and thin DD does not pay for a barrier at every level.
+     * Waiting cannot deadlock since the smallest unfinished node taken by
+     * a thread always has finished children.
+     * @param evals the evaluators for each thread.
+     * @param work the values indexed by node numbers.
+     */
+    template<typename S, typename T>
+    void evaluateMP(MyVector<S>& evals, MyVector<T>& work) const {
+        size_t const wideSize = evals.size() * WIDE_NODES_PER_THREAD;
+
+        std::vector<Segment> segments;
+        for (int i = 1; i <= topLevel_; ++i) {
+            bool wide = levelEnd(i) - levelBegin(i) >= wideSize;
+            if (!wide && !segments.empty() && !segments.back().wide) {
+                segments.back().to = levelEnd(i);
+            }
+            else {
+                Segment seg = {levelBegin(i), levelEnd(i), i, wide};
+                segments.push_back(seg);
+            }
+        }
+
+        MyVector<int> ready(numNodes());
+        MyVector<size_t> next(segments.size());
+        for (size_t f = 0; f < ready.size(); ++f) {
+            ready[f] = 0;
+        }
+        for (size_t s = 0; s < segments.size(); ++s) {
+            next[s] = segments[s].from;
+        }
+
+#pragma omp parallel num_threads(evals.size())
+        {
+            int const k = omp_get_thread_num();
+            int const threads = omp_get_num_threads();
+            S& ev = evals[k];
+            ev.initialize(topLevel_);
+
+            for (size_t s = 0; s < segments.size(); ++s) {
+                Segment const& seg = segments[s];
+
+                if (seg.wide) {
+                    size_t const m = seg.to - seg.from;
+                    evaluateRange(ev, work, seg.level,
+                                  Index(seg.from + m * k / threads),
+                                  Index(seg.from + m * (k + 1) / threads));
+#pragma omp barrier
+                    continue;
+                }
+
+                for (;;) {
+                    size_t from;
+#pragma omp atomic capture
+                    {
+                        from = next[s];
+                        next[s] += CHUNK_SIZE;
+                    }
+                    if (from >= seg.to) break;
+                    Index const to = Index(std::min(from + CHUNK_SIZE,
+                                                    size_t(seg.to)));
+
+                    for (Index f = Index(from); f < to; ++f) {
+                        for (int b = 0; b < ARITY; ++b) {
+                            Index g = branch_[b][f];
+                            if (g < seg.from) continue;
+                            for (;;) {
+                                int r;
+#pragma omp atomic read
+                                r = ready[g];
+                                if (r) break;
+                            }
+                        }
+#pragma omp flush
+                        evaluateRange(ev, work, level_[f], f, f + 1);
+#pragma omp flush
+#pragma omp atomic write
+                        ready[f] = 1;
+                    }
+                }
+#pragma omp barrier
+            }
+        }
+    }
+#endif
+};
+
+} // namespace tdzdd
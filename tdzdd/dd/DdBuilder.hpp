@@ -24,15 +24,19 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <ostream>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
+#include "DdProfile.hpp"
 #include "DdSweeper.hpp"
 #include "Node.hpp"
 #include "NodeTable.hpp"
@@ -45,6 +49,40 @@
 
 namespace tdzdd {
 
+/**
+ * Optional controls of top-down DD construction.
+ */
+struct DdBuildOption {
+    size_t maxSize; ///< The maximum number of nodes (0 for no limit).
+    size_t maxWidth; ///< The maximum number of nodes per level (0 for no limit).
+    bool relaxed; ///< Excess nodes go to the 1-terminal instead of the 0-terminal.
+    DdProfile* profile; ///< Storage of per-level statistics (null for none).
+
+    DdBuildOption() :
+            maxSize(0), maxWidth(0), relaxed(false), profile(0) {
+    }
+};
+
+/**
+ * Exception thrown when a DD under construction exceeds its size limit.
+ */
+class DdSizeLimitExceeded: public std::runtime_error {
+    size_t size_;
+
+public:
+    DdSizeLimitExceeded(size_t size) :
+            std::runtime_error("DD size limit exceeded"), size_(size) {
+    }
+
+    /**
+     * Gets the number of nodes when the construction was aborted.
+     * @return the number of nodes.
+     */
+    size_t size() const {
+        return size_;
+    }
+};
+
 class DdBuilderBase {
 protected:
     static int const headerSize = 1;
@@ -188,12 +226,103 @@ class DdBuilder: DdBuilderBase {
     void* const one;
     MyVector<NodeBranchId> oneSrcPtr;
 
+    size_t maxWidth;
+    bool relaxed;
+    DdProfile* profile;
+
     void init(int n) {
         snodeTable.resize(n + 1);
         if (n >= output.numRows()) output.setNumRows(n + 1);
         oneSrcPtr.clear();
     }
 
+    struct PriorityGreater {
+        Spec const& spec;
+        int level;
+
+        PriorityGreater(Spec const& spec, int level) :
+                spec(spec), level(level) {
+        }
+
+        bool operator()(SpecNode const* p, SpecNode const* q) const {
+            return spec.priority(state(p), level)
+                    > spec.priority(state(q), level);
+        }
+    };
+
+    /**
+     * Unique nodes of a level waiting for numbering under the width limit.
+     * Since the source pointer of a node shares the storage with its node ID,
+     * the source pointers are saved here and the node ID holds the index
+     * into this table.
+     */
+    struct WidthLimiter {
+        std::vector<SpecNode*> nodes;
+        std::vector<NodeId*> srcs;
+        std::vector<bool> forwarded;
+        std::vector<std::pair<NodeId*,size_t> > dups;
+
+        void clear() {
+            nodes.clear();
+            srcs.clear();
+            forwarded.clear();
+            dups.clear();
+        }
+
+        void add(SpecNode* p) {
+            size_t k = nodes.size();
+            nodes.push_back(p);
+            srcs.push_back(srcPtr(p));
+            forwarded.push_back(false);
+            nodeId(p) = NodeId(0, k + 2);
+        }
+
+        static size_t index(SpecNode* p) {
+            return nodeId(p).col() - 2;
+        }
+    };
+
+    WidthLimiter limiter;
+
+    /**
+     * Keeps at most maxWidth unique nodes of a level and forwards the others
+     * to a terminal, then numbers the remaining nodes.
+     * @param i level.
+     * @param m the next column number.
+     * @return the next column number.
+     */
+    size_t limitWidth(int i, size_t m) {
+        std::vector<SpecNode*> live;
+
+        for (size_t k = 0; k < limiter.nodes.size(); ++k) {
+            if (!limiter.forwarded[k]) live.push_back(limiter.nodes[k]);
+        }
+
+        if (live.size() > maxWidth) {
+            std::nth_element(live.begin(), live.begin() + maxWidth, live.end(),
+                    PriorityGreater(spec, i));
+            for (size_t k = maxWidth; k < live.size(); ++k) {
+                size_t kk = WidthLimiter::index(live[k]);
+                *limiter.srcs[kk] = relaxed ? 1 : 0;
+                nodeId(live[k]) = 1; // unused
+            }
+        }
+
+        for (size_t k = 0; k < limiter.nodes.size(); ++k) {
+            SpecNode* p = limiter.nodes[k];
+            if (nodeId(p) == 1) continue;
+            *limiter.srcs[k] = NodeId(i, m++);
+            nodeId(p) = limiter.forwarded[k] ? NodeId(0) : *limiter.srcs[k];
+        }
+
+        for (size_t k = 0; k < limiter.dups.size(); ++k) {
+            *limiter.dups[k].first = *limiter.srcs[limiter.dups[k].second];
+        }
+
+        limiter.clear();
+        return m;
+    }
+
 public:
     DdBuilder(Spec const& spec, NodeTableHandler<AR>& output, int n = 0) :
             spec(spec),
@@ -201,10 +330,34 @@ public:
             output(output.privateEntity()),
             sweeper(this->output, oneSrcPtr),
             oneStorage(spec.datasize()),
-            one(oneStorage.data()) {
+            one(oneStorage.data()),
+            maxWidth(0),
+            relaxed(false),
+            profile(0) {
         if (n >= 1) init(n);
     }
 
+    /**
+     * Sets the storage of per-level statistics.
+     * The statistics of each level are appended by construct(int).
+     * @param p the storage (null to stop profiling).
+     */
+    void setProfile(DdProfile* p) {
+        profile = p;
+    }
+
+    /**
+     * Limits the number of nodes on each level.
+     * Nodes of low priority are forwarded to the 0-terminal, which gives a
+     * restricted DD, or to the 1-terminal, which gives a relaxed DD.
+     * @param width the maximum width (0 for no limit).
+     * @param toOne forward excess nodes to the 1-terminal.
+     */
+    void setMaxWidth(size_t width, bool toOne) {
+        maxWidth = width;
+        relaxed = toOne;
+    }
+
     ~DdBuilder() {
         if (!oneSrcPtr.empty()) {
             spec.destruct(one);
@@ -263,10 +416,14 @@ public:
         size_t m = j0;
         int lowestChild = i - 1;
         size_t deadCount = 0;
+        DdLevelProfile prof(i);
+        prof.generated = snodes.size();
+        prof.stateBytes = snodes.size() * specNodeSize * sizeof(SpecNode);
 
         {
             Hasher<Spec> hasher(spec, i);
             UniqTable uniq(snodes.size() * 2, hasher, hasher);
+            bool const limited = maxWidth > 0;
 
             for (MyList<SpecNode>::iterator t = snodes.begin();
                     t != snodes.end(); ++t) {
@@ -274,13 +431,20 @@ public:
                 SpecNode*& p0 = uniq.add(p);
 
                 if (p0 == p) {
-                    nodeId(p) = *srcPtr(p) = NodeId(i, m++);
+                    if (limited) limiter.add(p);
+                    else nodeId(p) = *srcPtr(p) = NodeId(i, m++);
                 }
                 else {
                     switch (spec.merge_states(state(p0), state(p))) {
                     case 1:
-                        nodeId(p0) = 0; // forward to 0-terminal
-                        nodeId(p) = *srcPtr(p) = NodeId(i, m++);
+                        if (limited) {
+                            limiter.forwarded[WidthLimiter::index(p0)] = true;
+                            limiter.add(p);
+                        }
+                        else {
+                            nodeId(p0) = 0; // forward to 0-terminal
+                            nodeId(p) = *srcPtr(p) = NodeId(i, m++);
+                        }
                         p0 = p;
                         break;
                     case 2:
@@ -288,12 +452,22 @@ public:
                         nodeId(p) = 1; // unused
                         break;
                     default:
-                        *srcPtr(p) = nodeId(p0);
+                        if (limited) {
+                            limiter.dups.push_back(std::make_pair(srcPtr(p),
+                                    WidthLimiter::index(p0)));
+                        }
+                        else {
+                            *srcPtr(p) = nodeId(p0);
+                        }
                         nodeId(p) = 1; // unused
                         break;
                     }
                 }
             }
+
+            if (limited) m = limitWidth(i, m);
+            prof.tableSize = uniq.tableSize();
+            prof.probes = uniq.collisions();
 //#ifdef DEBUG
 //            MessageHandler mh;
 //            mh << "table_size[" << i << "] = " << uniq.tableSize() << "\n";
@@ -385,6 +559,14 @@ public:
         snodeTable[i - 1].pop_front();
         spec.destructLevel(i);
         sweeper.update(i, lowestChild, deadCount);
+
+        if (profile) {
+            prof.unique = m - j0;
+            prof.nodeBytes = prof.unique * sizeof(Node<AR>);
+            prof.dead = deadCount;
+            prof.swept = sweeper.swept();
+            profile->levels.push_back(prof);
+        }
     }
 };
 
@@ -585,7 +767,7 @@ public:
                 size_t m = output[i].size();
                 for (int x = 0; x < tasks; ++x) {
                     size_t j = nodeColumn[x];
-                    nodeColumn[x] = (j >= 1) ? m : -1; // -1 for skip
+                    nodeColumn[x] = (j >= 1) ? m : size_t(-1); // -1 for skip
                     m += j;
                 }
 
@@ -600,7 +782,7 @@ public:
 #pragma omp for schedule(dynamic)
 #endif
             for (int x = 0; x < tasks; ++x) {
-                if (nodeColumn[x] < 0) continue; // -1 for skip
+                if (nodeColumn[x] == size_t(-1)) continue; // -1 for skip
                 size_t j0 = nodeColumn[x] - 1;   // code(p) >= 1
 
                 for (int y = 0; y < threads; ++y) {
@@ -0,0 +1,107 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace tdzdd {
+
+/**
+ * Statistics of one level of top-down DD construction.
+ */
+struct DdLevelProfile {
+    int level;           ///< The level.
+    size_t generated;    ///< The number of states generated for the level.
+    size_t unique;       ///< The number of nodes after merging equivalent states.
+    size_t dead;         ///< The number of nodes whose branches are all 0.
+    size_t swept;        ///< The number of nodes removed by the sweeper.
+    size_t tableSize;    ///< The number of slots of the unique table.
+    size_t probes;       ///< The number of extra probes in the unique table.
+    size_t stateBytes;   ///< Bytes of the states generated for the level.
+    size_t nodeBytes;    ///< Bytes of the nodes of the level.
+    double time;         ///< Wall clock time in seconds.
+
+    DdLevelProfile(int level = 0) :
+            level(level), generated(0), unique(0), dead(0), swept(0),
+            tableSize(0), probes(0), stateBytes(0), nodeBytes(0), time(0) {
+    }
+
+    /**
+     * Gets the load factor of the unique table.
+     * @return the load factor.
+     */
+    double load() const {
+        return tableSize ? double(unique) / tableSize : 0.0;
+    }
+};
+
+/**
+ * Per-level profile of top-down DD construction.
+ */
+struct DdProfile {
+    std::string spec;                    ///< Name of the DD spec.
+    std::vector<DdLevelProfile> levels;  ///< Statistics from the top level.
+    size_t size;                         ///< The number of nodes finally built.
+    double time;                         ///< Total wall clock time in seconds.
+
+    DdProfile() :
+            size(0), time(0) {
+    }
+
+    /**
+     * Dumps the profile in JSON format.
+     * @param os the output stream.
+     */
+    void dumpJson(std::ostream& os) const {
+        os << "{\n";
+        os << "  \"spec\": \"";
+        for (size_t k = 0; k < spec.size(); ++k) {
+            char c = spec[k];
+            if (c == '"' || c == '\\') os << '\\';
+            os << c;
+        }
+        os << "\",\n";
+        os << "  \"size\": " << size << ",\n";
+        os << "  \"time\": " << time << ",\n";
+        os << "  \"levels\": [";
+        for (size_t k = 0; k < levels.size(); ++k) {
+            DdLevelProfile const& l = levels[k];
+            os << (k ? ",\n" : "\n");
+            os << "    {\"level\": " << l.level << ", \"generated\": "
+               << l.generated << ", \"unique\": " << l.unique << ", \"dead\": "
+               << l.dead << ", \"swept\": " << l.swept << ", \"table_size\": "
+               << l.tableSize << ", \"load\": " << l.load() << ", \"probes\": "
+               << l.probes << ", \"state_bytes\": " << l.stateBytes
+               << ", \"node_bytes\": " << l.nodeBytes << ", \"time\": "
+               << l.time << "}";
+        }
+        os << "\n  ]\n";
+        os << "}\n";
+    }
+};
+
+} // namespace tdzdd
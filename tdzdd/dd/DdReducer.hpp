@@ -24,10 +24,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <ostream>
 #include <stdexcept>
+#include <vector>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -36,7 +38,6 @@
 #include "Node.hpp"
 #include "NodeTable.hpp"
 #include "../util/MyHashTable.hpp"
-#include "../util/MyList.hpp"
 #include "../util/MyVector.hpp"
 
 namespace tdzdd {
@@ -50,32 +51,7 @@ class DdReducer {
     MyVector<MyVector<NodeId> > newIdTable;
     MyVector<MyVector<NodeId*> > rootPtr;
 
-    struct ReducNodeInfo {
-        Node<ARITY> children;
-        size_t column;
-
-        size_t hash() const {
-            return children.hash();
-        }
-
-        bool operator==(ReducNodeInfo const& o) const {
-            return children == o.children;
-        }
-
-        friend std::ostream& operator<<(std::ostream& os,
-                                        ReducNodeInfo const& o) {
-            return os << "(" << o.children << " -> " << o.column << ")";
-        }
-    };
-
 #ifdef _OPENMP
-    static int const TASKS_PER_THREAD = 10;
-
-    int const threads;
-    int const tasks;
-    MyVector<MyVector<MyList<ReducNodeInfo> > > taskMatrix;
-    MyVector<size_t> baseColumn;
-
 #ifdef DEBUG
     ElapsedTimeCounter etcP1, etcP2, etcP3, etcS0, etcS1, etcS2, etcS3, etcS4;
 #endif
@@ -91,18 +67,12 @@ public:
             output(newDiagram.privateEntity()),
             newIdTable(input.numRows()),
             rootPtr(input.numRows()),
-#ifdef _OPENMP
-            threads(omp_get_max_threads()),
-            tasks(MyHashConstant::primeSize(TASKS_PER_THREAD * threads)),
-            taskMatrix(threads),
-            baseColumn(tasks + 1),
-#endif
             readyForSequentialReduction(false) {
 #ifdef _OPENMP
 #ifdef DEBUG
         if (useMP) {
             MessageHandler mh;
-            mh << "#thread = " << threads << ", #task = " << tasks;
+            mh << "#thread = " << omp_get_max_threads();
         }
         etcS0.start();
 #endif
@@ -117,9 +87,6 @@ public:
         newIdTable[0][1] = 1;
 
 #ifdef _OPENMP
-        for (int y = 0; y < threads; ++y) {
-            taskMatrix[y].resize(tasks);
-        }
 #ifdef DEBUG
         etcS0.stop();
 #endif
@@ -398,8 +365,24 @@ private:
         }
     }
 
+    /**
+     * Finds the slot of a node in the concurrent unique table of a level.
+     * @param f the node.
+     * @param mask the table size minus one.
+     * @return the initial slot.
+     */
+    static size_t slotOf(Node<ARITY> const& f, size_t mask) {
+        size_t h = f.hash();
+        return (h ^ (h >> 31)) & mask;
+    }
+
     /**
      * Reduces one level using OpenMP.
+     * Nodes are hashed by their canonical children into an open-addressing
+     * table shared by all threads, whose slots are claimed by
+     * compare-and-swap and keep the smallest column of equivalent nodes.
+     * The canonical nodes are then numbered by a prefix sum over the
+     * threads, which gives the same result as the sequential reduction.
      * @param i level.
      */
     void reduceMP_(int i) {
@@ -411,6 +394,16 @@ private:
 #endif
         size_t const m = input[i].size();
         newIdTable[i].resize(m);
+        MyVector<NodeId>& newId = newIdTable[i];
+
+        size_t tableSize = 2;
+        while (tableSize < m * 2) {
+            tableSize <<= 1;
+        }
+        size_t const mask = tableSize - 1;
+        std::vector<std::atomic<size_t> > table(tableSize);
+        MyVector<size_t> rep(m);
+        MyVector<size_t> count(omp_get_max_threads() + 1);
 #ifdef DEBUG
         etcS1.stop();
         etcP1.start();
@@ -418,11 +411,19 @@ private:
 
 #pragma omp parallel
         {
-            int y = omp_get_thread_num();
-            MyHashTable<ReducNodeInfo const*> uniq;
+            int const y = omp_get_thread_num();
+            int const yy = omp_get_num_threads();
+            size_t const from = m * y / yy;
+            size_t const to = m * (y + 1) / yy;
 
 #pragma omp for schedule(static)
-            for (size_t j = 0; j < m; ++j) {
+            for (intmax_t k = 0; k < intmax_t(tableSize); ++k) {
+                table[k].store(0, std::memory_order_relaxed);
+            }
+
+#pragma omp for schedule(static)
+            for (intmax_t jj = 0; jj < intmax_t(m); ++jj) {
+                size_t const j = jj;
                 Node<ARITY>& f = input[i][j];
 
                 // make f canonical
@@ -437,15 +438,23 @@ private:
                 }
 
                 if (del) { // f is redundant
-                    newIdTable[i][j] = f0;
+                    newId[j] = f0;
+                    rep[j] = m;
                     continue;
                 }
-
-                // schedule a task
-                int x = f.hash() % tasks;
-                ReducNodeInfo* p = taskMatrix[y][x].alloc_front();
-                p->children = f;
-                p->column = j;
+                rep[j] = j;
+
+                // keep the smallest column in the slot of f
+                for (size_t k = slotOf(f, mask);; k = (k + 1) & mask) {
+                    size_t v = table[k].load(std::memory_order_acquire);
+                    if (v == 0 && table[k].compare_exchange_strong(v, j + 1,
+                            std::memory_order_acq_rel)) break;
+                    if (!(input[i][v - 1] == f)) continue;
+                    while (j + 1 < v && !table[k].compare_exchange_weak(v,
+                            j + 1, std::memory_order_acq_rel)) {
+                    }
+                    break;
+                }
             }
 
 #pragma omp single
@@ -464,84 +473,51 @@ private:
 #endif
             }
 
-#pragma omp for schedule(dynamic)
-            for (int x = 0; x < tasks; ++x) {
-                size_t mm = 0;
-                for (int yy = 0; yy < threads; ++yy) {
-                    mm += taskMatrix[yy][x].size();
-                }
-                if (mm == 0) {
-                    baseColumn[x + 1] = 0;
-                    continue;
-                }
-
-                uniq.initialize(mm * 2);
-                size_t j = 0;
-
-                for (int yy = 0; yy < threads; ++yy) {
-                    MyList<ReducNodeInfo>& taskq = taskMatrix[yy][x];
-
-                    for (typename MyList<ReducNodeInfo>::iterator t =
-                            taskq.begin(); t != taskq.end(); ++t) {
-                        ReducNodeInfo const* p = *t;
-                        ReducNodeInfo const* pp = uniq.add(p);
-
-                        if (pp == p) {
-                            newIdTable[i][p->column] =
-                                    NodeId(i + x,
-                                           j++,
-                                           p->children.branch[0].hasEmpty()); // row += task ID
-                        }
-                        else {
-                            newIdTable[i][p->column] =
-                                    newIdTable[i][pp->column];
-                        }
+            size_t c = 0;
+            for (size_t j = from; j < to; ++j) {
+                if (rep[j] == m) continue;
+                Node<ARITY> const& f = input[i][j];
+                size_t k = slotOf(f, mask);
+                for (;;) {
+                    size_t v = table[k].load(std::memory_order_relaxed);
+                    if (input[i][v - 1] == f) {
+                        rep[j] = v - 1;
+                        break;
                     }
+                    k = (k + 1) & mask;
                 }
-
-                baseColumn[x + 1] = j;
-            }
-
-            for (int x = 0; x < tasks; ++x) {
-                taskMatrix[y][x].clear();
+                if (rep[j] == j) ++c;
             }
+            count[y + 1] = c;
 
+#pragma omp barrier
 #pragma omp single
             {
 #ifdef DEBUG
                 etcP2.stop();
                 etcS3.start();
 #endif
-                for (int x = 1; x < tasks; ++x) {
-                    baseColumn[x + 1] += baseColumn[x];
+                count[0] = 0;
+                for (int x = 1; x < yy; ++x) {
+                    count[x + 1] += count[x];
                 }
-
-//                for (int k = 1; k < tasks; k <<= 1) {
-//#pragma omp for schedule(static)
-//                    for (int x = k; x < tasks; ++x) {
-//                        if (x & k) {
-//                            int w = (x & ~k) | (k - 1);
-//                            baseColumn[x + 1] += baseColumn[w + 1];
-//                        }
-//                    }
-//                }
-
-                output.initRow(i, baseColumn[tasks]);
+                output.initRow(i, count[yy]);
 #ifdef DEBUG
                 etcS3.stop();
                 etcP3.start();
 #endif
             }
 
-#pragma omp for schedule(static)
-            for (size_t j = 0; j < m; ++j) {
-                NodeId& ff = newIdTable[i][j];
-                if (ff.row() >= i) {
-                    ff = NodeId(i,
-                                ff.col() + baseColumn[ff.row() - i],
-                                ff.getAttr());
-                    output[i][ff.col()] = input[i][j];
-                }
+            c = count[y];
+            for (size_t j = from; j < to; ++j) {
+                if (rep[j] != j) continue;
+                newId[j] = NodeId(i, c, input[i][j].branch[0].hasEmpty());
+                output[i][c++] = input[i][j];
+            }
+
+#pragma omp barrier
+            for (size_t j = from; j < to; ++j) {
+                if (rep[j] != m && rep[j] != j) newId[j] = newId[rep[j]];
             }
         }
 #ifdef DEBUG
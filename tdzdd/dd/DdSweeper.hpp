@@ -50,6 +50,7 @@ class DdSweeper {
     MyVector<size_t> deadCount;
     size_t allCount;
     size_t maxCount;
+    size_t lastSwept;
     NodeId* rootPtr;
 
 public:
@@ -58,7 +59,8 @@ public:
      * @param diagram the diagram to sweep.
      */
     DdSweeper(NodeTableEntity<ARITY>& diagram) :
-            diagram(diagram), oneSrcPtr(0), allCount(0), maxCount(0), rootPtr(0) {
+            diagram(diagram), oneSrcPtr(0), allCount(0), maxCount(0),
+            lastSwept(0), rootPtr(0) {
     }
 
     /**
@@ -72,6 +74,7 @@ public:
             oneSrcPtr(&oneSrcPtr),
             allCount(0),
             maxCount(0),
+            lastSwept(0),
             rootPtr(0) {
     }
 
@@ -83,6 +86,14 @@ public:
         rootPtr = &root;
     }
 
+    /**
+     * Gets the number of nodes removed by the last update.
+     * @return the number of nodes removed.
+     */
+    size_t swept() const {
+        return lastSwept;
+    }
+
     /**
      * Updates status and sweeps the DD if necessary.
      * @param current current level.
@@ -92,6 +103,7 @@ public:
     void update(int current, int child, size_t count) {
         assert(1 <= current);
         assert(0 <= child);
+        lastSwept = 0;
         if (current <= 1) return;
 
         if (size_t(current) >= sweepLevel.size()) {
@@ -119,6 +131,7 @@ public:
 
         MessageHandler mh;
         mh.begin("sweeping") << " <" << diagram.size() << "> ...";
+        size_t const sizeBefore = diagram.size();
 
         for (int i = k; i < diagram.numRows(); ++i) {
             size_t m = diagram[i].size();
@@ -163,6 +176,7 @@ public:
         *rootPtr = newId[rootPtr->row()][rootPtr->col()];
         deadCount[k] = 0;
         allCount = diagram.size();
+        lastSwept = sizeBefore - diagram.size();
         mh.end(diagram.size());
     }
 };
@@ -0,0 +1,154 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+#include "../DdSpec.hpp"
+
+namespace tdzdd {
+
+/**
+ * BDD specification that prunes nodes of small probability mass.
+ * Each state carries the probability of reaching it from the root, which is
+ * accumulated when equivalent states are merged.
+ * A node whose mass is less than epsilon is diverted to the 0-terminal
+ * and the mass of its non-terminal children is added to @p diverted.
+ * Therefore, the probability of the resulting BDD is a lower bound of
+ * that of the original one, and adding the diverted mass gives an upper
+ * bound.
+ * Since the masses on each level sum up to at most 1, no level has more
+ * than 1/epsilon surviving nodes.
+ * The mass is also used as the priority when the width is limited.
+ *
+ * The diverted mass is accumulated without synchronization;
+ * use the single-threaded builder.
+ */
+template<typename S>
+class MassPruning: public PodArrayDdSpec<MassPruning<S>,size_t,2> {
+    typedef S Spec;
+    typedef size_t Word;
+
+    static size_t const massWords = (sizeof(double) + sizeof(Word) - 1)
+            / sizeof(Word);
+
+    Spec spec;
+    int const stateWords;
+    std::vector<double> const& prob;
+    double const epsilon;
+    double* const diverted;
+
+    static int wordSize(int size) {
+        return (size + sizeof(Word) - 1) / sizeof(Word);
+    }
+
+    double& mass(void* p) const {
+        return *static_cast<double*>(p);
+    }
+
+    double mass(void const* p) const {
+        return *static_cast<double const*>(p);
+    }
+
+    void* state(void* p) const {
+        return static_cast<Word*>(p) + massWords;
+    }
+
+    void const* state(void const* p) const {
+        return static_cast<Word const*>(p) + massWords;
+    }
+
+public:
+    /**
+     * Constructor.
+     * @param s the original BDD specification.
+     * @param prob probability of the 1-branch at each level.
+     * @param epsilon nodes of less mass are pruned.
+     * @param diverted storage where the pruned mass is added.
+     */
+    MassPruning(S const& s, std::vector<double> const& prob, double epsilon,
+                double* diverted)
+            : spec(s), stateWords(wordSize(spec.datasize())), prob(prob),
+              epsilon(epsilon), diverted(diverted) {
+        MassPruning::setArraySize(massWords + stateWords);
+    }
+
+    int getRoot(Word* p) {
+        mass(p) = 1.0;
+        return spec.get_root(state(p));
+    }
+
+    int getChild(Word* p, int level, int value) {
+        double m = mass(p) * (value ? prob[level] : 1.0 - prob[level]);
+        int ii = spec.get_child(state(p), level, value);
+        if (ii <= 0) return ii;
+        if (mass(p) < epsilon) {
+            *diverted += m;
+            return 0;
+        }
+        mass(p) = m;
+        return ii;
+    }
+
+    void get_copy(void* to, void const* from) {
+        mass(to) = mass(from);
+        spec.get_copy(state(to), state(from));
+    }
+
+    void destruct(void* p) {
+        spec.destruct(state(p));
+    }
+
+    void destructLevel(int level) {
+        spec.destructLevel(level);
+    }
+
+    int merge_states(void* p1, void* p2) {
+        int k = spec.merge_states(state(p1), state(p2));
+        if (k == 0) mass(p1) += mass(p2);
+        return k;
+    }
+
+    double priority(void const* p, int level) const {
+        return mass(p);
+    }
+
+    size_t hash_code(void const* p, int level) const {
+        return spec.hash_code(state(p), level);
+    }
+
+    bool equal_to(void const* p, void const* q, int level) const {
+        return spec.equal_to(state(p), state(q), level);
+    }
+
+    void print_state(std::ostream& os, void const* p, int level) const {
+        os << "<" << mass(p) << ",";
+        spec.print_state(os, state(p), level);
+        os << ">";
+    }
+};
+
+} // namespace tdzdd
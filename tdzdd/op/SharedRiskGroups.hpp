@@ -0,0 +1,267 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+#include "../DdSpec.hpp"
+
+namespace tdzdd {
+
+/**
+ * BDD specification of an edge-indexed specification with shared-risk
+ * groups.
+ * The original specification must not skip levels, as FrontierBasedSearch
+ * does not; a skipped edge would leave the variables of the groups
+ * starting there as don't-cares and the failed slots of the groups ending
+ * there uncleared.
+ * A group is a set of edges that fail together when the group fails.
+ * A variable of each group is inserted just above the first of its edges
+ * in the variable order, and an edge works only when its own variable and
+ * the variables of all of its groups are 1.
+ * The state carries the failed groups among those that are decided and
+ * still have undecided edges, which is at most 64 groups at a time.
+ * The levels of the original specification are n, ..., 1 for the edges
+ * 0, ..., n-1; the levels of this specification are n+g, ..., 1 for the
+ * g groups and the n edges interleaved.  Groups without edges are ignored.
+ */
+template<typename S>
+class SharedRiskGroups: public PodArrayDdSpec<SharedRiskGroups<S>,size_t,2> {
+    typedef S Spec;
+    typedef size_t Word;
+
+    Spec spec;
+    int const n;
+    int numLevels;
+    std::vector<int> edgeOfLevel;  ///< Edge at each level; -1 for groups.
+    std::vector<int> innerLevel;   ///< Original level at each level.
+    std::vector<int> groupOfLevel; ///< Group at each level; -1 for edges.
+    std::vector<int> slotOfLevel;  ///< Slot of the group at each level.
+    std::vector<int> levelOfEdge;  ///< Level of the topmost item of each edge.
+    std::vector<uint64_t> groupsOfEdge; ///< Slots of the groups of each edge.
+    std::vector<uint64_t> lastOfEdge;   ///< Slots of groups ending at each edge.
+
+    static int wordSize(int size) {
+        return (size + sizeof(Word) - 1) / sizeof(Word);
+    }
+
+    uint64_t& failed(Word* p) const {
+        return *reinterpret_cast<uint64_t*>(p);
+    }
+
+    uint64_t failed(Word const* p) const {
+        return *reinterpret_cast<uint64_t const*>(p);
+    }
+
+    void* state(Word* p) const {
+        return p + 1;
+    }
+
+    void const* state(Word const* p) const {
+        return p + 1;
+    }
+
+    int toLevel(int innerLevel) const {
+        return innerLevel <= 0 ? innerLevel : levelOfEdge[n - innerLevel];
+    }
+
+public:
+    /**
+     * Constructor.
+     * @param s the original specification.
+     * @param n the number of edges.
+     * @param groups the edges of each group, numbered from 0.
+     * @exception std::runtime_error more than 64 groups overlap.
+     */
+    SharedRiskGroups(S const& s, int n,
+                     std::vector<std::vector<int> > const& groups)
+            : spec(s), n(n), numLevels(n), levelOfEdge(n), groupsOfEdge(n),
+              lastOfEdge(n) {
+        std::vector<int> first(groups.size(), n);
+        std::vector<int> last(groups.size(), -1);
+        for (size_t k = 0; k < groups.size(); ++k) {
+            for (size_t t = 0; t < groups[k].size(); ++t) {
+                int a = groups[k][t];
+                if (a < 0 || n <= a) throw std::runtime_error(
+                        "SharedRiskGroups: edge out of range");
+                first[k] = std::min(first[k], a);
+                last[k] = std::max(last[k], a);
+            }
+            if (!groups[k].empty()) ++numLevels;
+        }
+        edgeOfLevel.resize(numLevels + 1, -1);
+        innerLevel.resize(numLevels + 1, 0);
+        groupOfLevel.resize(numLevels + 1, -1);
+        slotOfLevel.resize(numLevels + 1, -1);
+
+        // assign levels from the top and reuse slots of finished groups
+        uint64_t used = 0;
+        std::vector<int> slot(groups.size(), -1);
+        int level = numLevels;
+        for (int a = 0; a < n; ++a) {
+            levelOfEdge[a] = level;
+            for (size_t k = 0; k < groups.size(); ++k) {
+                if (first[k] != a) continue;
+                if (~used == 0) throw std::runtime_error(
+                        "SharedRiskGroups: more than 64 groups overlap");
+                int b = 0;
+                while (used >> b & 1) {
+                    ++b;
+                }
+                used |= uint64_t(1) << b;
+                slot[k] = b;
+                innerLevel[level] = n - a;
+                groupOfLevel[level] = k;
+                slotOfLevel[level--] = b;
+            }
+            innerLevel[level] = n - a;
+            edgeOfLevel[level--] = a;
+
+            for (size_t k = 0; k < groups.size(); ++k) {
+                if (first[k] > a || last[k] < a) continue;
+                for (size_t t = 0; t < groups[k].size(); ++t) {
+                    if (groups[k][t] == a) {
+                        groupsOfEdge[a] |= uint64_t(1) << slot[k];
+                    }
+                }
+                if (last[k] == a) {
+                    lastOfEdge[a] |= uint64_t(1) << slot[k];
+                    used &= ~(uint64_t(1) << slot[k]);
+                }
+            }
+        }
+        assert(level == 0);
+        SharedRiskGroups::setArraySize(1 + wordSize(spec.datasize()));
+    }
+
+    /**
+     * Gets the number of variables.
+     * @return the number of edges and groups.
+     */
+    int numVars() const {
+        return numLevels;
+    }
+
+    /**
+     * Gets the edge at a level.
+     * @param level the level.
+     * @return the edge number, or -1 for a group.
+     */
+    int edgeAt(int level) const {
+        return edgeOfLevel[level];
+    }
+
+    /**
+     * Gets the group at a level.
+     * @param level the level.
+     * @return the group number, or -1 for an edge.
+     */
+    int groupAt(int level) const {
+        return groupOfLevel[level];
+    }
+
+    /**
+     * Arranges probabilities of edges and groups by level.
+     * @param edgeProb probability of each edge.
+     * @param groupProb probability of each group.
+     * @return the probability at each level; index 0 is unused.
+     */
+    std::vector<double> levelProbabilities(std::vector<double> const& edgeProb,
+            std::vector<double> const& groupProb) const {
+        std::vector<double> prob(numLevels + 1, 0.0);
+        for (int i = 1; i <= numLevels; ++i) {
+            prob[i] = edgeOfLevel[i] >= 0 ? edgeProb[edgeOfLevel[i]]
+                                          : groupProb[groupOfLevel[i]];
+        }
+        return prob;
+    }
+
+    int getRoot(Word* p) {
+        failed(p) = 0;
+        int const i = spec.get_root(state(p));
+        assert(i <= 0 || i == n);
+        return toLevel(i);
+    }
+
+    int getChild(Word* p, int level, int value) {
+        int const a = edgeOfLevel[level];
+        if (a < 0) {
+            if (!value) failed(p) |= uint64_t(1) << slotOfLevel[level];
+            return level - 1;
+        }
+
+        bool works = value && (failed(p) & groupsOfEdge[a]) == 0;
+        failed(p) &= ~lastOfEdge[a];
+        int const i = spec.get_child(state(p), innerLevel[level], works);
+        assert(i <= 0 || i == innerLevel[level] - 1);
+        return toLevel(i);
+    }
+
+    void get_copy(void* to, void const* from) {
+        failed(static_cast<Word*>(to)) = failed(static_cast<Word const*>(from));
+        spec.get_copy(state(static_cast<Word*>(to)),
+                      state(static_cast<Word const*>(from)));
+    }
+
+    void destruct(void* p) {
+        spec.destruct(state(static_cast<Word*>(p)));
+    }
+
+    void destructLevel(int level) {
+        if (edgeOfLevel[level] >= 0) spec.destructLevel(innerLevel[level]);
+    }
+
+    int merge_states(void* p1, void* p2) {
+        return spec.merge_states(state(static_cast<Word*>(p1)),
+                                 state(static_cast<Word*>(p2)));
+    }
+
+    size_t hash_code(void const* p, int level) const {
+        Word const* w = static_cast<Word const*>(p);
+        size_t h = failed(w) * 314159257;
+        return h + spec.hash_code(state(w), innerLevel[level]);
+    }
+
+    bool equal_to(void const* p, void const* q, int level) const {
+        Word const* w = static_cast<Word const*>(p);
+        Word const* v = static_cast<Word const*>(q);
+        return failed(w) == failed(v)
+                && spec.equal_to(state(w), state(v), innerLevel[level]);
+    }
+
+    void print_state(std::ostream& os, void const* p, int level) const {
+        Word const* w = static_cast<Word const*>(p);
+        os << "<" << failed(w) << ",";
+        spec.print_state(os, state(w), innerLevel[level]);
+        os << ">";
+    }
+};
+
+} // namespace tdzdd
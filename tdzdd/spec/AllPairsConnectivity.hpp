@@ -0,0 +1,252 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "../DdSpec.hpp"
+#include "../util/Graph.hpp"
+
+namespace tdzdd {
+
+/**
+ * Connectivity of all pairs of sites in a graph with unreliable edges.
+ * Every subset of edges is accepted; the state is the partition of the
+ * frontier vertices into components together with the set of sites
+ * contained in each component, and the probability mass of reaching the
+ * state from the root, which is accumulated when equal states are merged.
+ * When the last vertex of a component leaves the frontier, the mass of the
+ * transition is added to the final set of sites of the component.
+ * Two sites are connected in a random subgraph exactly when they end up in
+ * the same final set, so that a single construction gives the reliability
+ * of every pair.
+ * Up to 64 sites are supported.
+ *
+ * The masses are accumulated without synchronization;
+ * use the single-threaded builder.
+ */
+class AllPairsConnectivity: public PodArrayDdSpec<AllPairsConnectivity,
+        uint64_t,2> {
+public:
+    typedef uint64_t Word;
+    typedef std::unordered_map<Word,double> ComponentMass;
+
+private:
+    static Word const NONE = ~Word(0);
+
+    Graph const& graph;
+    int const n;
+    int const mateSize;
+    std::vector<double> const& prob;
+    std::vector<Word> siteBit;
+    ComponentMass* const finished;
+
+    static double mass(Word const* s) {
+        double m;
+        std::memcpy(&m, s, sizeof(m));
+        return m;
+    }
+
+    static void setMass(Word* s, double m) {
+        std::memcpy(s, &m, sizeof(m));
+    }
+
+    static Word& label(Word* s, int k) {
+        return s[1 + 2 * k];
+    }
+
+    static Word& sites(Word* s, int k) {
+        return s[2 + 2 * k];
+    }
+
+    void initSlot(Word* s, int k, int v) const {
+        if (v <= graph.vertexSize()) {
+            label(s, k) = k;
+            sites(s, k) = siteBit[v];
+        }
+        else {
+            label(s, k) = NONE;
+            sites(s, k) = 0;
+        }
+    }
+
+    void connect(Word* s, int k1, int k2) const {
+        Word r1 = label(s, k1);
+        Word r2 = label(s, k2);
+        if (r1 == r2) return;
+        if (r1 > r2) std::swap(r1, r2);
+
+        for (int k = r2; k < mateSize; ++k) {
+            if (label(s, k) == r2) label(s, k) = r1;
+        }
+        sites(s, r1) |= sites(s, r2);
+        sites(s, r2) = 0;
+    }
+
+    void leave(Word* s, int k, double m) const {
+        Word const r = label(s, k);
+        label(s, k) = NONE;
+        int kk = -1;
+        for (int j = r; j < mateSize; ++j) {
+            if (label(s, j) == r) {
+                kk = j;
+                break;
+            }
+        }
+
+        if (kk < 0) { // the component is finished
+            Word const w = sites(s, r);
+            if (w & (w - 1)) (*finished)[w] += m;
+        }
+        else if (Word(k) == r) { // kk becomes the new head
+            for (int j = kk; j < mateSize; ++j) {
+                if (label(s, j) == r) label(s, j) = kk;
+            }
+            sites(s, kk) = sites(s, r);
+        }
+
+        if (Word(k) == r) sites(s, k) = 0;
+    }
+
+    void shift(Word* s, int d, int v0) const {
+        if (d == 0) return;
+        for (int k = 0; k < mateSize - d; ++k) {
+            Word l = label(s, k + d);
+            assert(l == NONE || l >= Word(d));
+            label(s, k) = (l == NONE) ? NONE : l - d;
+            sites(s, k) = sites(s, k + d);
+        }
+        for (int k = std::max(mateSize - d, 0); k < mateSize; ++k) {
+            initSlot(s, k, v0 + k);
+        }
+    }
+
+public:
+    /**
+     * Constructor.
+     * @param graph the graph.
+     * @param siteList the sites.
+     * @param prob probability of the 1-branch at each level.
+     * @param finished storage where the mass of each final set of sites is
+     *        added; the set is a bit mask over @p siteList.
+     * @exception std::runtime_error more than 64 sites are given.
+     */
+    AllPairsConnectivity(Graph const& graph, std::vector<int> const& siteList,
+                         std::vector<double> const& prob,
+                         ComponentMass* finished)
+            : graph(graph), n(graph.edgeSize()),
+              mateSize(graph.maxFrontierSize()), prob(prob),
+              siteBit(graph.vertexSize() + 1), finished(finished) {
+        if (siteList.size() > 64) throw std::runtime_error(
+                "AllPairsConnectivity: at most 64 sites are supported");
+        for (size_t t = 0; t < siteList.size(); ++t) {
+            siteBit[siteList[t]] |= Word(1) << t;
+        }
+        setArraySize(1 + 2 * mateSize);
+    }
+
+    int getRoot(Word* s) const {
+        int const v0 = graph.edgeInfo(0).v0;
+        setMass(s, 1.0);
+        for (int k = 0; k < mateSize; ++k) {
+            initSlot(s, k, v0 + k);
+        }
+        return n;
+    }
+
+    int getChild(Word* s, int level, int take) const {
+        assert(1 <= level && level <= n);
+        int i = n - level;
+        Graph::EdgeInfo const& e = graph.edgeInfo(i);
+        double const m = mass(s) * (take ? prob[level] : 1.0 - prob[level]);
+
+        if (take) connect(s, e.v1 - e.v0, e.v2 - e.v0);
+        if (e.v2final) leave(s, e.v2 - e.v0, m);
+        if (e.v1final) leave(s, e.v1 - e.v0, m);
+
+        if (++i == n) return -1;
+
+        Graph::EdgeInfo const& ee = graph.edgeInfo(i);
+        shift(s, ee.v0 - e.v0, ee.v0);
+        setMass(s, m);
+        return n - i;
+    }
+
+    int mergeStates(Word* s1, Word* s2) const {
+        setMass(s1, mass(s1) + mass(s2));
+        return 0;
+    }
+
+    size_t hashCode(Word const* s) const {
+        size_t h = 0;
+        for (int k = 1; k < 1 + 2 * mateSize; ++k) {
+            h += s[k];
+            h *= 314159257;
+        }
+        return h;
+    }
+
+    bool equalTo(Word const* s1, Word const* s2) const {
+        for (int k = 1; k < 1 + 2 * mateSize; ++k) {
+            if (s1[k] != s2[k]) return false;
+        }
+        return true;
+    }
+
+    /**
+     * Computes the probability that each pair of sites is connected.
+     * @param finished the masses of the final sets of sites.
+     * @param numSites the number of sites.
+     * @return the probabilities in row-major order; the diagonal is 1.
+     */
+    static std::vector<double> pairMatrix(ComponentMass const& finished,
+                                          int numSites) {
+        std::vector<double> matrix(numSites * numSites, 0.0);
+        for (ComponentMass::const_iterator t = finished.begin();
+                t != finished.end(); ++t) {
+            for (int a = 0; a < numSites; ++a) {
+                if (!(t->first >> a & 1)) continue;
+                for (int b = a + 1; b < numSites; ++b) {
+                    if (t->first >> b & 1) matrix[a * numSites + b] += t->second;
+                }
+            }
+        }
+        for (int a = 0; a < numSites; ++a) {
+            matrix[a * numSites + a] = 1.0;
+            for (int b = a + 1; b < numSites; ++b) {
+                matrix[b * numSites + a] = matrix[a * numSites + b];
+            }
+        }
+        return matrix;
+    }
+};
+
+} // namespace tdzdd
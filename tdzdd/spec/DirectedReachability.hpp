@@ -0,0 +1,298 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+#include "../DdSpec.hpp"
+#include "../util/Graph.hpp"
+
+namespace tdzdd {
+
+/**
+ * Reachability from the source terminal to all other terminals in a
+ * directed graph.
+ * Each edge of @p graph is an arc as given by Graph::EdgeInfo::reversed.
+ *
+ * The state is the reachability relation of the processed arcs among the
+ * frontier vertices and the terminals, kept as a bit matrix of slots.
+ * The row of the source slot is the set of slots reached from the source,
+ * and the column of a terminal slot is the set of frontier vertices that
+ * reach the terminal, which is kept after the terminal leaves the
+ * frontier.  Once a frontier vertex is reached from the source, the
+ * vertices it reaches are reached as well, so that its row and column are
+ * cleared and states differing only in such pairs are merged.
+ */
+class DirectedReachability: public PodArrayDdSpec<DirectedReachability,
+        uint64_t,2> {
+    typedef uint64_t Word;
+
+    Graph const& graph;
+    int const n;
+    int const mateSize;
+    std::vector<int> anchorOf; ///< Slot of each terminal; -1 for none.
+    int numAnchors;
+    int size;                  ///< Number of slots.
+    int words;                 ///< Number of words in a row.
+    bool reachable;            ///< All terminals are reached by all arcs.
+
+    bool get(Word const* s, int x, int y) const {
+        return (s[x * words + (y >> 6)] >> (y & 63)) & 1;
+    }
+
+    void set(Word* s, int x, int y) const {
+        s[x * words + (y >> 6)] |= Word(1) << (y & 63);
+    }
+
+    void reset(Word* s, int x, int y) const {
+        s[x * words + (y >> 6)] &= ~(Word(1) << (y & 63));
+    }
+
+    void clearSlot(Word* s, int x) const {
+        std::fill(s + x * words, s + (x + 1) * words, Word(0));
+        for (int y = 0; y < size; ++y) {
+            reset(s, y, x);
+        }
+    }
+
+    void initSlot(Word* s, int k, int v) const {
+        clearSlot(s, k);
+        if (v > graph.vertexSize()) return;
+        set(s, k, k);
+
+        int const a = anchorOf[v];
+        if (a == mateSize) {
+            set(s, a, a);
+            set(s, a, k);
+        }
+        else if (a > mateSize) {
+            set(s, a, a);
+            set(s, k, a);
+        }
+    }
+
+    /**
+     * Adds an arc between two frontier slots.
+     * Every slot reaching @p u reaches what @p v reaches.
+     */
+    void connect(Word* s, int u, int v) const {
+        Word const* rv = s + v * words;
+        for (int x = 0; x < size; ++x) {
+            if (!get(s, x, u)) continue;
+            Word* rx = s + x * words;
+            for (int w = 0; w < words; ++w) {
+                rx[w] |= rv[w];
+            }
+        }
+    }
+
+    /**
+     * Clears the slots of terminals reached from the source and the
+     * relation of frontier vertices reached from the source.
+     * @return true if all terminals are reached.
+     */
+    bool settle(Word* s) const {
+        int const a0 = mateSize;
+        for (int x = 0; x < mateSize; ++x) {
+            if (!get(s, x, x) || !get(s, a0, x)) continue;
+            clearSlot(s, x);
+            set(s, x, x);
+            set(s, a0, x);
+        }
+
+        bool all = true;
+        for (int a = a0 + 1; a < size; ++a) {
+            if (get(s, a0, a)) {
+                if (get(s, a, a)) {
+                    clearSlot(s, a);
+                    set(s, a0, a);
+                }
+            }
+            else {
+                all = false;
+            }
+        }
+        return all;
+    }
+
+    /**
+     * Tells if a terminal can no longer be reached from the source.
+     */
+    bool hopeless(Word const* s) const {
+        int const a0 = mateSize;
+        bool const sourceEntered = get(s, a0, a0);
+        bool sourceOpen = false;
+        for (int x = 0; x < mateSize; ++x) {
+            if (get(s, x, x) && get(s, a0, x)) sourceOpen = true;
+        }
+
+        for (int a = a0 + 1; a < size; ++a) {
+            if (get(s, a0, a)) continue; // reached
+            if (sourceEntered && !sourceOpen) return true;
+            if (!get(s, a, a)) continue; // not entered
+            bool open = false;
+            for (int x = 0; x < mateSize; ++x) {
+                if (get(s, x, x) && get(s, x, a)) open = true;
+            }
+            if (!open) return true;
+        }
+        return false;
+    }
+
+    void shift(Word* s, int d, int v0) const {
+        if (d == 0) return;
+        // The source of each bit comes at or after the bit itself.
+        for (int x = 0; x < size; ++x) {
+            int const xx = x < mateSize ? x + d : x;
+            for (int y = 0; y < size; ++y) {
+                int const yy = y < mateSize ? y + d : y;
+                if ((xx < mateSize || x >= mateSize)
+                    && (yy < mateSize || y >= mateSize) && get(s, xx, yy)) {
+                    set(s, x, y);
+                }
+                else {
+                    reset(s, x, y);
+                }
+            }
+        }
+        for (int k = std::max(mateSize - d, 0); k < mateSize; ++k) {
+            initSlot(s, k, v0 + k);
+        }
+    }
+
+    /**
+     * Tells if the source reaches all terminals when all arcs are taken.
+     */
+    bool allReachable() const {
+        int const m = graph.vertexSize();
+        std::vector<std::vector<int> > out(m + 1);
+        for (int a = 0; a < n; ++a) {
+            Graph::EdgeInfo const& e = graph.edgeInfo(a);
+            if (e.reversed) {
+                out[e.v2].push_back(e.v1);
+            }
+            else {
+                out[e.v1].push_back(e.v2);
+            }
+        }
+
+        std::vector<bool> seen(m + 1);
+        std::vector<int> stack;
+        for (int v = 1; v <= m; ++v) {
+            if (anchorOf[v] == mateSize) {
+                seen[v] = true;
+                stack.push_back(v);
+            }
+        }
+        while (!stack.empty()) {
+            int const u = stack.back();
+            stack.pop_back();
+            for (size_t j = 0; j < out[u].size(); ++j) {
+                int const w = out[u][j];
+                if (seen[w]) continue;
+                seen[w] = true;
+                stack.push_back(w);
+            }
+        }
+
+        for (int v = 1; v <= m; ++v) {
+            if (anchorOf[v] >= 0 && !seen[v]) return false;
+        }
+        return true;
+    }
+
+public:
+    /**
+     * Constructor.
+     * The terminals are the colored vertices of @p graph.
+     * @param graph the directed graph.
+     * @param source the source terminal; 0 for the terminal with the
+     *        smallest vertex number.
+     * @exception std::runtime_error @p source is not a terminal.
+     */
+    DirectedReachability(Graph const& graph, int source = 0)
+            : graph(graph), n(graph.edgeSize()),
+              mateSize(graph.maxFrontierSize()),
+              anchorOf(graph.vertexSize() + 1, -1), numAnchors(0) {
+        if (source < 0 || graph.vertexSize() < source
+            || (source > 0 && graph.colorNumber(source) == 0)) {
+            throw std::runtime_error(
+                    "DirectedReachability: the source must be a terminal");
+        }
+        if (source > 0) anchorOf[source] = mateSize + numAnchors++;
+        for (int v = 1; v <= graph.vertexSize(); ++v) {
+            if (graph.colorNumber(v) == 0 || v == source) continue;
+            anchorOf[v] = mateSize + numAnchors++;
+        }
+        size = mateSize + std::max(numAnchors, 1);
+        words = (size + 63) / 64;
+        setArraySize(size * words);
+        reachable = allReachable();
+    }
+
+    int getRoot(Word* s) const {
+        if (numAnchors <= 1) return -1;
+        if (!reachable) return 0;
+        std::fill(s, s + size * words, Word(0));
+        int const v0 = graph.edgeInfo(0).v0;
+        for (int k = 0; k < mateSize; ++k) {
+            initSlot(s, k, v0 + k);
+        }
+        return n;
+    }
+
+    int getChild(Word* s, int level, int take) const {
+        assert(1 <= level && level <= n);
+        int i = n - level;
+        Graph::EdgeInfo const& e = graph.edgeInfo(i);
+
+        if (take) {
+            int const u = e.v1 - e.v0;
+            int const v = e.v2 - e.v0;
+            if (e.reversed) {
+                connect(s, v, u);
+            }
+            else {
+                connect(s, u, v);
+            }
+            if (settle(s)) return -1;
+        }
+        if (e.v2final) clearSlot(s, e.v2 - e.v0);
+        if (e.v1final) clearSlot(s, e.v1 - e.v0);
+
+        if (++i == n) return 0;
+        if (hopeless(s)) return 0;
+
+        Graph::EdgeInfo const& ee = graph.edgeInfo(i);
+        shift(s, ee.v0 - e.v0, ee.v0);
+        return n - i;
+    }
+};
+
+} // namespace tdzdd
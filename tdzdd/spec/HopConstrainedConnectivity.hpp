@@ -0,0 +1,370 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+#include "../DdSpec.hpp"
+#include "../util/Graph.hpp"
+
+namespace tdzdd {
+
+/**
+ * Connectivity of terminals within a hop limit.
+ * A subset of edges is accepted when every terminal is joined to the
+ * source terminal by a path of at most @p hops edges.
+ *
+ * The state is the matrix of distances, counted in edges of the processed
+ * part of the graph, between the frontier vertices and an anchor slot of
+ * each terminal.  An anchor copies the distances of its terminal when the
+ * terminal enters the frontier and keeps them after it leaves, so that the
+ * distance to the source is still updated through frontier vertices.
+ * Distances are capped at @p hops + 1, distances between two anchors other
+ * than the source are not kept, and the anchor of a terminal is cleared
+ * once the terminal is near enough to the source, so that states differing
+ * only in irrelevant distances are merged.
+ */
+class HopConstrainedConnectivity: public PodArrayDdSpec<
+        HopConstrainedConnectivity,uint8_t,2> {
+    typedef uint8_t Dist;
+
+    Graph const& graph;
+    int const n;
+    int const mateSize;
+    int const hops;
+    Dist const inf;
+    std::vector<int> anchorOf; ///< Anchor slot of each vertex; -1 for none.
+    std::vector<int> terminal; ///< Vertex of each anchor.
+    std::vector<std::vector<Dist> > staticDist; ///< Distances in the graph.
+    int numAnchors;
+    int size;                  ///< Number of slots.
+    mutable std::vector<int> entry;      ///< Work area of lowerBounds().
+    mutable std::vector<int> fromSource; ///< Work areas of prune().
+    mutable std::vector<int> toTerminal;
+    mutable std::vector<int> lower;
+
+    Dist& at(Dist* s, int x, int y) const {
+        return s[x * size + y];
+    }
+
+    Dist at(Dist const* s, int x, int y) const {
+        return s[x * size + y];
+    }
+
+    /**
+     * Tells if the distance between two slots is kept.
+     */
+    bool kept(int x, int y) const {
+        return x < mateSize || y < mateSize || x == mateSize || y == mateSize;
+    }
+
+    void clearSlot(Dist* s, int x) const {
+        for (int y = 0; y < size; ++y) {
+            at(s, x, y) = at(s, y, x) = inf;
+        }
+    }
+
+    void initSlot(Dist* s, int k, int v) const {
+        clearSlot(s, k);
+        if (v > graph.vertexSize()) return;
+        at(s, k, k) = 0;
+
+        int const a = anchorOf[v];
+        if (a >= 0) {
+            at(s, a, a) = 0;
+            at(s, a, k) = at(s, k, a) = 0;
+        }
+    }
+
+    /**
+     * Adds an edge between two frontier slots.
+     * Distances updated in place are still lengths of paths in the new
+     * graph, so that the order of the updates does not matter.
+     */
+    void connect(Dist* s, int u, int v) const {
+        for (int x = 0; x < size; ++x) {
+            for (int y = x; y < size; ++y) {
+                if (!kept(x, y)) continue;
+                int d = std::min(at(s, x, u) + 1 + at(s, v, y),
+                                 at(s, x, v) + 1 + at(s, u, y));
+                if (d < at(s, x, y)) at(s, x, y) = at(s, y, x) = d;
+            }
+        }
+    }
+
+    /**
+     * Clears the anchors of terminals near enough to the source.
+     * @return true if all terminals are near enough.
+     */
+    bool settle(Dist* s) const {
+        int const a0 = mateSize;
+        bool all = true;
+        for (int a = a0 + 1; a < size; ++a) {
+            if (at(s, a, a0) == 0 && at(s, a, a) == inf) continue;
+            if (at(s, a, a0) <= hops) {
+                clearSlot(s, a);
+                at(s, a, a0) = at(s, a0, a) = 0;
+            }
+            else {
+                all = false;
+            }
+        }
+        return all;
+    }
+
+    /**
+     * Gets lower bounds of the final distances from a terminal.
+     * A path from the terminal to a processed vertex is either processed
+     * entirely or enters the processed part at a frontier vertex.
+     * @param s the state.
+     * @param a the anchor of the terminal.
+     * @param v0 the vertex of the first frontier slot.
+     * @param bound bound[x] receives the lower bound of slot x.
+     */
+    void lowerBounds(Dist const* s, int a, int v0,
+                     std::vector<int>& bound) const {
+        std::vector<Dist> const& g = staticDist[a - mateSize];
+        bool const entered = at(s, a, a) == 0;
+        int nearest = inf;
+        for (int u = 0; u < mateSize; ++u) {
+            nearest = std::min<int>(nearest, at(s, a, u));
+        }
+
+        std::fill(entry.begin(), entry.end(), inf);
+        for (int u = 0; u < mateSize; ++u) {
+            if (at(s, u, u) != 0) continue;
+            entry[u] = g[v0 + u];
+            if (entered) entry[u] = std::max(entry[u],
+                    std::min<int>(at(s, a, u), nearest + 1));
+        }
+
+        for (int x = 0; x < size; ++x) {
+            int b = at(s, a, x);
+            for (int u = 0; u < mateSize; ++u) {
+                b = std::min(b, entry[u] + at(s, u, x));
+            }
+            if (x < mateSize && at(s, x, x) == 0) b = std::max<int>(b, g[v0 + x]);
+            bound[x] = std::min<int>(b, inf);
+        }
+    }
+
+    /**
+     * Finds terminals that can no longer come near enough to the source
+     * and forgets distances on no path short enough, by bounding the
+     * remaining part of each path with the distances in the whole graph.
+     * @param s the state.
+     * @param v0 the vertex of the first frontier slot.
+     * @return false if some terminal cannot come near enough.
+     */
+    bool prune(Dist* s, int v0) const {
+        int const a0 = mateSize;
+        std::fill(toTerminal.begin(), toTerminal.end(), inf);
+        lowerBounds(s, a0, v0, fromSource);
+
+        for (int a = a0 + 1; a < size; ++a) {
+            if (at(s, a, a0) == 0 && at(s, a, a) == inf) continue; // settled
+            if (at(s, a, a) != 0) { // not entered
+                int const v = terminal[a - mateSize];
+                bool const sourceEntered = at(s, a0, a0) == 0;
+                int d = staticDist[0][v];
+                if (sourceEntered) {
+                    int m = inf;
+                    for (int u = 0; u < mateSize; ++u) {
+                        if (at(s, u, u) != 0) continue;
+                        m = std::min(m, fromSource[u]
+                                + staticDist[a - mateSize][v0 + u]);
+                    }
+                    d = std::max(d, m);
+                }
+                if (d > hops) return false;
+            }
+            else if (fromSource[a] > hops) {
+                return false;
+            }
+
+            lowerBounds(s, a, v0, lower);
+            for (int x = 0; x < mateSize; ++x) {
+                toTerminal[x] = std::min(toTerminal[x], lower[x]);
+            }
+            toTerminal[a] = 0;
+        }
+        fromSource[a0] = 0;
+
+        for (int x = 0; x < mateSize; ++x) {
+            for (int y = x + 1; y < size; ++y) {
+                int const d = at(s, x, y);
+                if (d >= inf) continue;
+                if (std::min(fromSource[x] + toTerminal[y],
+                             fromSource[y] + toTerminal[x]) + d > hops) {
+                    at(s, x, y) = at(s, y, x) = inf;
+                }
+            }
+        }
+        return true;
+    }
+
+    void shift(Dist* s, int d, int v0) const {
+        if (d == 0) return;
+        // The source of each entry comes at or after the entry itself.
+        for (int x = 0; x < size; ++x) {
+            int const xx = x < mateSize ? x + d : x;
+            for (int y = 0; y < size; ++y) {
+                int const yy = y < mateSize ? y + d : y;
+                at(s, x, y) = (xx < mateSize || x >= mateSize)
+                        && (yy < mateSize || y >= mateSize) ?
+                        at(s, xx, yy) : inf;
+            }
+        }
+        for (int k = std::max(mateSize - d, 0); k < mateSize; ++k) {
+            initSlot(s, k, v0 + k);
+        }
+    }
+
+    /**
+     * Computes the distances from each terminal in the whole graph by BFS.
+     */
+    void computeStaticDistances() {
+        int const m = graph.vertexSize();
+        std::vector<std::vector<int> > adj(m + 1);
+        for (int a = 0; a < n; ++a) {
+            Graph::EdgeInfo const& e = graph.edgeInfo(a);
+            adj[e.v1].push_back(e.v2);
+            adj[e.v2].push_back(e.v1);
+        }
+
+        staticDist.resize(numAnchors);
+        std::vector<int> queue;
+        for (int t = 0; t < numAnchors; ++t) {
+            std::vector<Dist>& g = staticDist[t];
+            g.assign(m + 1, inf);
+            g[terminal[t]] = 0;
+            queue.assign(1, terminal[t]);
+            for (size_t k = 0; k < queue.size(); ++k) {
+                int const u = queue[k];
+                if (g[u] + 1 >= inf) break;
+                for (size_t j = 0; j < adj[u].size(); ++j) {
+                    int const w = adj[u][j];
+                    if (g[w] != inf) continue;
+                    g[w] = g[u] + 1;
+                    queue.push_back(w);
+                }
+            }
+        }
+    }
+
+public:
+    /**
+     * Constructor.
+     * The terminals are the colored vertices of @p graph.
+     * @param graph the graph.
+     * @param hops the maximum number of edges between the source and
+     *        each terminal.
+     * @param source the source terminal; 0 for the terminal with the
+     *        smallest vertex number.
+     * @exception std::runtime_error @p hops or @p source is out of range.
+     */
+    HopConstrainedConnectivity(Graph const& graph, int hops, int source = 0)
+            : graph(graph), n(graph.edgeSize()),
+              mateSize(graph.maxFrontierSize()), hops(hops), inf(hops + 1),
+              anchorOf(graph.vertexSize() + 1, -1), numAnchors(0) {
+        if (hops < 0 || 254 < hops) throw std::runtime_error(
+                "HopConstrainedConnectivity: hops must be in [0, 254]");
+        if (source < 0 || graph.vertexSize() < source
+            || (source > 0 && graph.colorNumber(source) == 0)) {
+            throw std::runtime_error(
+                    "HopConstrainedConnectivity: the source must be a terminal");
+        }
+        if (source > 0) anchorOf[source] = mateSize + numAnchors++;
+        for (int v = 1; v <= graph.vertexSize(); ++v) {
+            if (graph.colorNumber(v) == 0 || v == source) continue;
+            anchorOf[v] = mateSize + numAnchors++;
+        }
+        size = mateSize + std::max(numAnchors, 1);
+        setArraySize(size * size);
+        entry.resize(mateSize);
+        fromSource.resize(size);
+        toTerminal.resize(size);
+        lower.resize(size);
+
+        terminal.resize(numAnchors);
+        for (int v = 1; v <= graph.vertexSize(); ++v) {
+            if (anchorOf[v] >= 0) terminal[anchorOf[v] - mateSize] = v;
+        }
+        computeStaticDistances();
+    }
+
+    int getRoot(Dist* s) const {
+        if (numAnchors <= 1) return -1;
+        for (int t = 1; t < numAnchors; ++t) {
+            if (staticDist[0][terminal[t]] > hops) return 0;
+        }
+        std::fill(s, s + size * size, inf);
+        int const v0 = graph.edgeInfo(0).v0;
+        for (int k = 0; k < mateSize; ++k) {
+            initSlot(s, k, v0 + k);
+        }
+        return n;
+    }
+
+    int getChild(Dist* s, int level, int take) const {
+        assert(1 <= level && level <= n);
+        int i = n - level;
+        Graph::EdgeInfo const& e = graph.edgeInfo(i);
+
+        if (take) {
+            connect(s, e.v1 - e.v0, e.v2 - e.v0);
+            if (settle(s)) return -1;
+        }
+        if (e.v2final) clearSlot(s, e.v2 - e.v0);
+        if (e.v1final) clearSlot(s, e.v1 - e.v0);
+
+        if (++i == n) return 0;
+        if (!prune(s, e.v0)) return 0;
+
+        Graph::EdgeInfo const& ee = graph.edgeInfo(i);
+        shift(s, ee.v0 - e.v0, ee.v0);
+        return n - i;
+    }
+
+    size_t hashCode(Dist const* s) const {
+        size_t h = 0;
+        for (int k = 0; k < size * size; ++k) {
+            h += s[k];
+            h *= 314159257;
+        }
+        return h;
+    }
+
+    bool equalTo(Dist const* s1, Dist const* s2) const {
+        return std::memcmp(s1, s2, size * size) == 0;
+    }
+};
+
+} // namespace tdzdd
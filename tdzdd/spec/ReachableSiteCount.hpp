@@ -0,0 +1,256 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+#include "../DdSpec.hpp"
+#include "../util/Graph.hpp"
+
+namespace tdzdd {
+
+/**
+ * Number of sites connected to the source in a graph with unreliable
+ * edges.
+ * The state is the partition of the frontier vertices into components
+ * together with the number of sites in each component and a flag for the
+ * component of the source, and the probability mass of reaching the state
+ * from the root, which is accumulated when equal states are merged.
+ * When the last vertex of the component of the source leaves the
+ * frontier, the number of its sites is final; the mass of the transition
+ * is added to the probability of that number and the 1-terminal is
+ * returned.
+ * The source itself is not counted.
+ *
+ * The masses are accumulated without synchronization;
+ * use the single-threaded builder.
+ */
+class ReachableSiteCount: public PodArrayDdSpec<ReachableSiteCount,
+        uint64_t,2> {
+public:
+    typedef uint64_t Word;
+
+private:
+    static Word const NONE = ~Word(0);
+    static Word const SOURCE = Word(1) << 63; ///< Flag of the source.
+
+    Graph const& graph;
+    int const n;
+    int const mateSize;
+    std::vector<double> const& prob;
+    std::vector<Word> siteCount;
+    std::vector<double>* const distribution;
+
+    static double mass(Word const* s) {
+        double m;
+        std::memcpy(&m, s, sizeof(m));
+        return m;
+    }
+
+    static void setMass(Word* s, double m) {
+        std::memcpy(s, &m, sizeof(m));
+    }
+
+    static Word& label(Word* s, int k) {
+        return s[1 + 2 * k];
+    }
+
+    static Word& count(Word* s, int k) {
+        return s[2 + 2 * k];
+    }
+
+    void initSlot(Word* s, int k, int v) const {
+        if (v <= graph.vertexSize()) {
+            label(s, k) = k;
+            count(s, k) = siteCount[v];
+        }
+        else {
+            label(s, k) = NONE;
+            count(s, k) = 0;
+        }
+    }
+
+    void connect(Word* s, int k1, int k2) const {
+        Word r1 = label(s, k1);
+        Word r2 = label(s, k2);
+        if (r1 == r2) return;
+        if (r1 > r2) std::swap(r1, r2);
+
+        for (int k = r2; k < mateSize; ++k) {
+            if (label(s, k) == r2) label(s, k) = r1;
+        }
+        Word const flags = (count(s, r1) | count(s, r2)) & SOURCE;
+        count(s, r1) = ((count(s, r1) + count(s, r2)) & ~SOURCE) | flags;
+        count(s, r2) = 0;
+    }
+
+    /**
+     * Removes a vertex from the frontier.
+     * @return true if the component of the source is finished.
+     */
+    bool leave(Word* s, int k, double m) const {
+        Word const r = label(s, k);
+        label(s, k) = NONE;
+        int kk = -1;
+        for (int j = r; j < mateSize; ++j) {
+            if (label(s, j) == r) {
+                kk = j;
+                break;
+            }
+        }
+
+        if (kk < 0) { // the component is finished
+            Word const c = count(s, r);
+            count(s, r) = 0;
+            if (c & SOURCE) {
+                (*distribution)[c & ~SOURCE] += m;
+                return true;
+            }
+            return false;
+        }
+
+        if (Word(k) == r) { // kk becomes the new head
+            for (int j = kk; j < mateSize; ++j) {
+                if (label(s, j) == r) label(s, j) = kk;
+            }
+            count(s, kk) = count(s, r);
+            count(s, k) = 0;
+        }
+        return false;
+    }
+
+    void shift(Word* s, int d, int v0) const {
+        if (d == 0) return;
+        for (int k = 0; k < mateSize - d; ++k) {
+            Word l = label(s, k + d);
+            assert(l == NONE || l >= Word(d));
+            label(s, k) = (l == NONE) ? NONE : l - d;
+            count(s, k) = count(s, k + d);
+        }
+        for (int k = std::max(mateSize - d, 0); k < mateSize; ++k) {
+            initSlot(s, k, v0 + k);
+        }
+    }
+
+public:
+    /**
+     * Constructor.
+     * The sites are the colored vertices of @p graph.
+     * @param graph the graph.
+     * @param source the source vertex.
+     * @param prob probability of the 1-branch at each level.
+     * @param distribution storage where the probability that @p c sites
+     *        are connected to the source is added to the @p c-th element.
+     * @exception std::runtime_error @p source is out of range.
+     */
+    ReachableSiteCount(Graph const& graph, int source,
+                       std::vector<double> const& prob,
+                       std::vector<double>* distribution)
+            : graph(graph), n(graph.edgeSize()),
+              mateSize(graph.maxFrontierSize()), prob(prob),
+              siteCount(graph.vertexSize() + 1), distribution(distribution) {
+        if (source < 1 || graph.vertexSize() < source) {
+            throw std::runtime_error(
+                    "ReachableSiteCount: the source must be a vertex");
+        }
+        int sites = 0;
+        for (int v = 1; v <= graph.vertexSize(); ++v) {
+            if (graph.colorNumber(v) == 0 || v == source) continue;
+            siteCount[v] = 1;
+            ++sites;
+        }
+        siteCount[source] |= SOURCE;
+        distribution->assign(sites + 1, 0.0);
+        setArraySize(1 + 2 * mateSize);
+    }
+
+    int getRoot(Word* s) const {
+        int const v0 = graph.edgeInfo(0).v0;
+        setMass(s, 1.0);
+        for (int k = 0; k < mateSize; ++k) {
+            initSlot(s, k, v0 + k);
+        }
+        return n;
+    }
+
+    int getChild(Word* s, int level, int take) const {
+        assert(1 <= level && level <= n);
+        int i = n - level;
+        Graph::EdgeInfo const& e = graph.edgeInfo(i);
+        double const m = mass(s) * (take ? prob[level] : 1.0 - prob[level]);
+
+        if (take) connect(s, e.v1 - e.v0, e.v2 - e.v0);
+        if (e.v2final && leave(s, e.v2 - e.v0, m)) return -1;
+        if (e.v1final && leave(s, e.v1 - e.v0, m)) return -1;
+
+        if (++i == n) return -1;
+
+        Graph::EdgeInfo const& ee = graph.edgeInfo(i);
+        shift(s, ee.v0 - e.v0, ee.v0);
+        setMass(s, m);
+        return n - i;
+    }
+
+    int mergeStates(Word* s1, Word* s2) const {
+        setMass(s1, mass(s1) + mass(s2));
+        return 0;
+    }
+
+    size_t hashCode(Word const* s) const {
+        size_t h = 0;
+        for (int k = 1; k < 1 + 2 * mateSize; ++k) {
+            h += s[k];
+            h *= 314159257;
+        }
+        return h;
+    }
+
+    bool equalTo(Word const* s1, Word const* s2) const {
+        for (int k = 1; k < 1 + 2 * mateSize; ++k) {
+            if (s1[k] != s2[k]) return false;
+        }
+        return true;
+    }
+
+    /**
+     * Computes the expected number of sites connected to the source.
+     * @param distribution the probability of each number of sites.
+     * @return the expected number.
+     */
+    static double expectation(std::vector<double> const& distribution) {
+        double e = 0.0;
+        for (size_t c = 1; c < distribution.size(); ++c) {
+            e += c * distribution[c];
+        }
+        return e;
+    }
+};
+
+} // namespace tdzdd
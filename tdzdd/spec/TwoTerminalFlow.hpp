@@ -0,0 +1,209 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+#include <vector>
+
+#include "../DdSpec.hpp"
+#include "../util/Graph.hpp"
+
+namespace tdzdd {
+
+/**
+ * Two-terminal flow of a required amount.
+ * A subset of edges is accepted when it can carry @p demand units of flow
+ * between the source and the sink, that is, when every cut between them
+ * keeps a capacity of @p demand or more by the max-flow min-cut theorem.
+ *
+ * The state has one entry for each assignment of the frontier vertices to
+ * the source side or the sink side of a cut.  The entry is the minimum
+ * capacity of the processed edges across the cut over all assignments of
+ * the vertices that have left the frontier, capped at @p demand.  An
+ * assignment putting the source on the sink side or the sink on the
+ * source side is disabled by the cap.  A vertex leaving the frontier is
+ * eliminated by taking the minimum of its two sides, so that the state
+ * size depends on the frontier width but not on the number of cuts.
+ */
+class TwoTerminalFlow: public PodArrayDdSpec<TwoTerminalFlow,uint16_t,2> {
+    typedef uint16_t Cap;
+
+    Graph const& graph;
+    int const n;
+    int const mateSize;
+    int const source;
+    int const sink;
+    Cap const demand;
+    std::vector<int> const& capacity;
+    std::vector<int> restCapacity; ///< Capacity of the edges from each one.
+    int size;                      ///< Number of assignments.
+    bool isolable;                 ///< A terminal has too little capacity.
+
+    void initSlot(Cap* s, int k, int v) const {
+        int side;
+        if (v == source) side = 1;
+        else if (v == sink) side = 0;
+        else return;
+
+        for (int x = 0; x < size; ++x) {
+            if (((x >> k) & 1) != side) s[x] = demand;
+        }
+    }
+
+    void connect(Cap* s, int u, int v, int c) const {
+        if (c == 0 || u == v) return;
+        for (int x = 0; x < size; ++x) {
+            if (((x >> u) & 1) == ((x >> v) & 1)) continue;
+            s[x] = std::min<int>(s[x] + c, demand);
+        }
+    }
+
+    void leave(Cap* s, int k) const {
+        int const bit = 1 << k;
+        for (int x = 0; x < size; ++x) {
+            if (x & bit) continue;
+            s[x] = s[x | bit] = std::min(s[x], s[x | bit]);
+        }
+    }
+
+    Cap minimum(Cap const* s) const {
+        return *std::min_element(s, s + size);
+    }
+
+    void shift(Cap* s, int d, int v0) const {
+        if (d == 0) return;
+        d = std::min(d, mateSize);
+        int const low = 1 << (mateSize - d);
+        // The source of each entry comes at or after the entry itself.
+        for (int x = 0; x < low; ++x) {
+            s[x] = s[(x << d) & (size - 1)];
+        }
+        for (int x = low; x < size; ++x) {
+            s[x] = s[x & (low - 1)];
+        }
+        for (int k = mateSize - d; k < mateSize; ++k) {
+            initSlot(s, k, v0 + k);
+        }
+    }
+
+public:
+    /**
+     * Constructor.
+     * @param graph the graph.
+     * @param source the source vertex.
+     * @param sink the sink vertex.
+     * @param demand the amount of flow.
+     * @param capacity capacity of each edge in edge order.
+     * @exception std::runtime_error an argument is out of range or the
+     *            frontier is too wide.
+     */
+    TwoTerminalFlow(Graph const& graph, int source, int sink, int demand,
+                    std::vector<int> const& capacity)
+            : graph(graph), n(graph.edgeSize()),
+              mateSize(graph.maxFrontierSize()), source(source), sink(sink),
+              demand(std::max(demand, 0)), capacity(capacity),
+              restCapacity(graph.edgeSize() + 1) {
+        if (source < 1 || graph.vertexSize() < source || sink < 1
+            || graph.vertexSize() < sink || source == sink) {
+            throw std::runtime_error(
+                    "TwoTerminalFlow: the source and the sink must be distinct vertices");
+        }
+        if (65535 < demand) throw std::runtime_error(
+                "TwoTerminalFlow: demand must be at most 65535");
+        if (int(capacity.size()) < n) throw std::runtime_error(
+                "TwoTerminalFlow: capacities are missing");
+        if (20 < mateSize) throw std::runtime_error(
+                "TwoTerminalFlow: the frontier is too wide");
+
+        int sourceCapacity = 0;
+        int sinkCapacity = 0;
+        for (int a = n - 1; a >= 0; --a) {
+            if (capacity[a] < 0) throw std::runtime_error(
+                    "TwoTerminalFlow: capacities must be nonnegative");
+            restCapacity[a] = std::min(restCapacity[a + 1] + capacity[a],
+                                       65535);
+            Graph::EdgeInfo const& e = graph.edgeInfo(a);
+            if (e.v1 == e.v2) continue;
+            if (e.v1 == source || e.v2 == source) {
+                sourceCapacity = std::min(sourceCapacity + capacity[a], 65535);
+            }
+            if (e.v1 == sink || e.v2 == sink) {
+                sinkCapacity = std::min(sinkCapacity + capacity[a], 65535);
+            }
+        }
+        isolable = std::min(sourceCapacity, sinkCapacity) < demand;
+        size = 1 << mateSize;
+        setArraySize(size);
+    }
+
+    int getRoot(Cap* s) const {
+        if (demand == 0) return -1;
+        if (isolable) return 0;
+        std::fill(s, s + size, 0);
+        int const v0 = graph.edgeInfo(0).v0;
+        for (int k = 0; k < mateSize; ++k) {
+            initSlot(s, k, v0 + k);
+        }
+        return n;
+    }
+
+    int getChild(Cap* s, int level, int take) const {
+        assert(1 <= level && level <= n);
+        int i = n - level;
+        Graph::EdgeInfo const& e = graph.edgeInfo(i);
+
+        if (take) connect(s, e.v1 - e.v0, e.v2 - e.v0, capacity[i]);
+        if (e.v2final) leave(s, e.v2 - e.v0);
+        if (e.v1final) leave(s, e.v1 - e.v0);
+
+        int const m = minimum(s);
+        if (m >= demand) return -1;
+        if (++i == n) return 0;
+        if (m + restCapacity[i] < demand) return 0;
+
+        Graph::EdgeInfo const& ee = graph.edgeInfo(i);
+        shift(s, ee.v0 - e.v0, ee.v0);
+        return n - i;
+    }
+
+    size_t hashCode(Cap const* s) const {
+        size_t h = 0;
+        for (int x = 0; x < size; ++x) {
+            h += s[x];
+            h *= 314159257;
+        }
+        return h;
+    }
+
+    bool equalTo(Cap const* s1, Cap const* s2) const {
+        return std::memcmp(s1, s2, size * sizeof(Cap)) == 0;
+    }
+};
+
+} // namespace tdzdd
@@ -36,8 +36,12 @@
 #include <sstream>
 #include <stdexcept>
 #include <stdint.h>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "StringInterner.hpp"
+
 namespace tdzdd {
 
 class Graph {
@@ -57,11 +61,12 @@ public:
         bool v2final2;
         bool allColorsSeen;
         bool finalEdge;
+        bool reversed; ///< The arc goes from v2 to v1 in a directed graph.
 
         EdgeInfo(VertexNumber v1, VertexNumber v2)
                 : v0(0), v1(v1), v2(v2), v1final(false), v2final(false),
                   v1final2(false), v2final2(false), allColorsSeen(false),
-                  finalEdge(false) {
+                  finalEdge(false), reversed(false) {
         }
 
         friend std::ostream& operator<<(std::ostream& os, EdgeInfo const& o) {
@@ -82,24 +87,57 @@ public:
     static ColorNumber const MAX_COLORS = USHRT_MAX;
 
 private:
-    std::vector<std::pair<std::string,std::string> > edgeNames;
-    std::map<std::string,std::string> name2label;
-    std::map<std::string,std::string> name2color;
-    std::map<std::string,VertexNumber> name2vertex;
-    std::vector<std::string> vertex2name;
-    std::map<std::pair<std::string,std::string>,EdgeNumber> name2edge;
-    std::vector<std::pair<std::string,std::string> > edge2name;
+    StringInterner names;
+    std::vector<std::pair<int,int> > edgeNames;
+    std::unordered_map<std::string,std::string> name2label;
+    std::unordered_map<std::string,std::string> name2color;
+    std::vector<VertexNumber> name2vertex;
+    std::vector<int> vertex2name;
+    std::vector<std::pair<int,int> > edge2name;
     std::vector<EdgeInfo> edgeInfo_;
-    std::map<VertexNumberPair,EdgeNumber> edgeIndex;
+    std::unordered_map<uint64_t,EdgeNumber> edgeIndex;
     std::vector<VertexNumber> virtualMate_;
     std::vector<ColorNumber> colorNumber_;
     VertexNumber vMax;
     ColorNumber numColor_;
     bool hasColorPairs_;
+    bool directed_;
 
 public:
+    Graph()
+            : vMax(0), numColor_(0), hasColorPairs_(false), directed_(false) {
+    }
+
+    /**
+     * Makes edges arcs from the first vertex to the second one.
+     * Arcs in opposite directions between two vertices are different edges.
+     * Call it before update().
+     * @param directed true for a directed graph.
+     */
+    void setDirected(bool directed) {
+        directed_ = directed;
+    }
+
+    bool isDirected() const {
+        return directed_;
+    }
+
     void addEdge(std::string vertexName1, std::string vertexName2) {
-        edgeNames.push_back(std::make_pair(vertexName1, vertexName2));
+        edgeNames.push_back(std::make_pair(names.intern(vertexName1),
+                                           names.intern(vertexName2)));
+    }
+
+    /**
+     * Adds an edge given by name pieces in a buffer, which are copied only
+     * when they are new vertex names.
+     * @param s1 the first character of the first vertex name.
+     * @param n1 the length of the first vertex name.
+     * @param s2 the first character of the second vertex name.
+     * @param n2 the length of the second vertex name.
+     */
+    void addEdge(char const* s1, size_t n1, char const* s2, size_t n2) {
+        edgeNames.push_back(std::make_pair(names.intern(s1, n1),
+                                           names.intern(s2, n2)));
     }
 
     void setColor(std::string v, std::string color) {
@@ -192,7 +230,7 @@ private:
 
                 if (c == '\n') {
                     if (!v1.empty() && !v2.empty()) {
-                        edgeNames.push_back(std::make_pair(v1, v2));
+                        addEdge(v1, v2);
                         v1.clear();
                         v2.clear();
                     }
@@ -208,7 +246,7 @@ private:
         }
 
         if (!v1.empty() && !v2.empty()) {
-            edgeNames.push_back(std::make_pair(v1, v2));
+            addEdge(v1, v2);
         }
         else if (!v1.empty()) {
             throw std::runtime_error("ERROR: Only one token in a line");
@@ -216,6 +254,7 @@ private:
     }
 
     void readAdjacencyList(std::istream& is) {
+        names.clear();
         edgeNames.clear();
         name2label.clear();
         name2color.clear();
@@ -232,7 +271,7 @@ private:
             is.unget();
             is >> v2;
 
-            edgeNames.push_back(std::make_pair(to_string(v1), to_string(v2)));
+            addEdge(to_string(v1), to_string(v2));
         }
     }
 
@@ -259,6 +298,10 @@ private:
         }
     }
 
+    static uint64_t pairKey(int a, int b) {
+        return (uint64_t(uint32_t(a)) << 32) | uint32_t(b);
+    }
+
     std::string getColor(int n) {
         char const HEX[] = "0123456789abcdef";
         std::string color("#000000");
@@ -282,47 +325,50 @@ public:
     void update() {
         name2vertex.clear();
         vertex2name.clear();
-        name2edge.clear();
         edge2name.clear();
         edgeInfo_.clear();
         edgeIndex.clear();
         vMax = 0;
 
         // Make unique edge name list
-        for (size_t i = 0; i < edgeNames.size(); ++i) {
-            std::pair<std::string,std::string> const& e = edgeNames[i];
-
-            if (name2edge.count(e) == 0) {
-                edge2name.push_back(e);
-                name2edge[e] = -1;
-                name2edge[std::make_pair(e.second, e.first)] = -1;
+        {
+            std::unordered_set<uint64_t> seen;
+            seen.reserve(edgeNames.size());
+
+            for (size_t i = 0; i < edgeNames.size(); ++i) {
+                std::pair<int,int> const& e = edgeNames[i];
+                uint64_t key = (directed_ || e.first < e.second) ?
+                        pairKey(e.first, e.second) :
+                        pairKey(e.second, e.first);
+                if (seen.insert(key).second) edge2name.push_back(e);
             }
         }
 
         // Sort vertices by leaving order
         {
-            std::vector<std::string> stack;
-            stack.reserve(edge2name.size() * 2);
+            std::vector<int> stack;
+            stack.reserve(names.size());
+            name2vertex.assign(names.size(), -1);
 
             for (size_t i = edge2name.size() - 1; i + 1 > 0; --i) {
-                std::string const& s1 = edge2name[i].first;
-                std::string const& s2 = edge2name[i].second;
+                int s1 = edge2name[i].first;
+                int s2 = edge2name[i].second;
 
-                if (name2vertex.count(s2) == 0) {
+                if (name2vertex[s2] < 0) {
                     name2vertex[s2] = 0;
                     stack.push_back(s2);
                 }
 
-                if (name2vertex.count(s1) == 0) {
+                if (name2vertex[s1] < 0) {
                     name2vertex[s1] = 0;
                     stack.push_back(s1);
                 }
             }
 
-            vertex2name.push_back(""); // begin vertex number with 1
+            vertex2name.push_back(-1); // begin vertex number with 1
 
             while (!stack.empty()) {
-                std::string const& s = stack.back();
+                int s = stack.back();
                 name2vertex[s] = vertex2name.size();
                 vertex2name.push_back(s);
                 if (vertex2name.size() > size_t(MAX_VERTICES)) throw std::runtime_error(
@@ -331,31 +377,27 @@ public:
             }
         }
 
-        for (size_t i = 0; i < edge2name.size(); ++i) {
-            std::pair<std::string,std::string> const& e = edge2name[i];
-            std::string s1 = e.first;
-            std::string s2 = e.second;
+        edgeInfo_.reserve(edge2name.size());
+        edgeIndex.reserve(edge2name.size());
 
-            if (name2vertex[s1] > name2vertex[s2]) {
-                std::swap(s1, s2);
+        for (size_t i = 0; i < edge2name.size(); ++i) {
+            std::pair<int,int> const& e = edge2name[i];
+            VertexNumber v1 = name2vertex[e.first];
+            VertexNumber v2 = name2vertex[e.second];
+            bool reversed = false;
+
+            if (v1 > v2) {
+                std::swap(v1, v2);
+                reversed = directed_;
             }
 
-            VertexNumber v1 = name2vertex[s1];
-            VertexNumber v2 = name2vertex[s2];
-
-            if (v1 == 0) throw std::runtime_error(
-                    "ERROR: " + s1 + ": No such vertex");
-            if (v2 == 0) throw std::runtime_error(
-                    "ERROR: " + s2 + ": No such vertex");
+            uint64_t key = reversed ? pairKey(v2, v1) : pairKey(v1, v2);
 
-            VertexNumberPair vp(v1, v2);
-
-            if (edgeIndex.count(vp) == 0) {
+            if (edgeIndex.count(key) == 0) {
                 EdgeNumber a = edgeInfo_.size();
                 edgeInfo_.push_back(EdgeInfo(v1, v2));
-                edgeIndex[vp] = a;
-                name2edge[std::make_pair(s1, s2)] = a;
-                name2edge[std::make_pair(s2, s1)] = a;
+                edgeInfo_.back().reversed = reversed;
+                edgeIndex[key] = a;
                 if (vMax < v2) vMax = v2;
             }
 
@@ -366,10 +408,11 @@ public:
         {
             std::map<std::string,std::set<VertexNumber> > color2vertices;
 
-            for (std::map<std::string,std::string>::iterator t =
+            for (std::unordered_map<std::string,std::string>::iterator t =
                     name2color.begin(); t != name2color.end(); ++t) {
-                VertexNumber v = name2vertex[t->first];
-                if (v == 0) throw std::runtime_error(
+                int s = names.find(t->first);
+                VertexNumber v = (s < 0) ? 0 : name2vertex[s];
+                if (v <= 0) throw std::runtime_error(
                         "ERROR: " + t->first + ": No such vertex");
                 color2vertices[t->second].insert(v); // color => set of vertices
             }
@@ -498,22 +541,21 @@ public:
     }
 
     VertexNumber getVertex(std::string const& name) const {
-        std::map<std::string,VertexNumber>::const_iterator found =
-                name2vertex.find(name);
-        if (found == name2vertex.end()) throw std::runtime_error(
-                "ERROR: " + name + ": No such vertex");
-        return found->second;
+        int s = names.find(name);
+        if (s < 0 || size_t(s) >= name2vertex.size() || name2vertex[s] <= 0)
+            throw std::runtime_error("ERROR: " + name + ": No such vertex");
+        return name2vertex[s];
     }
 
     std::string vertexName(VertexNumber v) const {
         if (v < 1 || vertexSize() < v) return "?";
-        return vertex2name[v];
+        return names.name(vertex2name[v]);
     }
 
     std::string vertexLabel(VertexNumber v) const {
         std::string label = vertexName(v);
 
-        std::map<std::string,std::string>::const_iterator found =
+        std::unordered_map<std::string,std::string>::const_iterator found =
                 name2label.find(label);
         if (found != name2label.end()) {
             label = found->second;
@@ -523,11 +565,19 @@ public:
     }
 
     EdgeNumber getEdge(std::pair<std::string,std::string> const& name) const {
-        std::map<std::pair<std::string,std::string>,EdgeNumber>::const_iterator found =
-                name2edge.find(name);
-        if (found == name2edge.end()) throw std::runtime_error(
+        int s1 = names.find(name.first);
+        int s2 = names.find(name.second);
+        if (s1 >= 0 && s2 >= 0 && size_t(s1) < name2vertex.size()
+                && size_t(s2) < name2vertex.size()) {
+            VertexNumber v1 = name2vertex[s1];
+            VertexNumber v2 = name2vertex[s2];
+            if (!directed_ && v1 > v2) std::swap(v1, v2);
+            std::unordered_map<uint64_t,EdgeNumber>::const_iterator found =
+                    edgeIndex.find(pairKey(v1, v2));
+            if (found != edgeIndex.end()) return found->second;
+        }
+        throw std::runtime_error(
                 "ERROR: " + name.first + "," + name.second + ": No such edge");
-        return found->second;
     }
 
     EdgeNumber getEdge(std::string const& name1,
@@ -537,14 +587,15 @@ public:
 
     std::pair<std::string,std::string> edgeName(EdgeNumber e) const {
         if (e < 0 || edgeSize() <= e) return std::make_pair("?", "?");
-        return edge2name[e];
+        return std::make_pair(names.name(edge2name[e].first),
+                              names.name(edge2name[e].second));
     }
 
     std::string edgeLabel(EdgeNumber e) const {
         std::pair<std::string,std::string> name = edgeName(e);
         std::string label = name.first + "," + name.second;
 
-        std::map<std::string,std::string>::const_iterator found =
+        std::unordered_map<std::string,std::string>::const_iterator found =
                 name2label.find(label);
         if (found != name2label.end()) {
             label = found->second;
@@ -560,10 +611,9 @@ public:
     EdgeNumber getEdge(VertexNumber v1, VertexNumber v2) const {
         assert(1 <= v1 && v1 <= vMax);
         assert(1 <= v2 && v2 <= vMax);
-        if (v1 > v2) std::swap(v1, v2);
-        VertexNumberPair vp(v1, v2);
-        std::map<VertexNumberPair,EdgeNumber>::const_iterator found =
-                edgeIndex.find(vp);
+        if (!directed_ && v1 > v2) std::swap(v1, v2);
+        std::unordered_map<uint64_t,EdgeNumber>::const_iterator found =
+                edgeIndex.find(pairKey(v1, v2));
         if (found == edgeIndex.end()) throw std::runtime_error(
                 "ERROR: (" + to_string(v1) + "," + to_string(v2)
                         + "): No such edge");
@@ -610,19 +660,18 @@ public:
 
     template<typename E>
     std::ostream& dump(std::ostream& os, E const& edgeDecorator) const {
-        os << "graph {\n";
+        os << (directed_ ? "digraph {\n" : "graph {\n");
         //os << "  layout=neato;\n";
 
-        for (std::vector<std::string>::const_iterator t = vertex2name.begin();
-                t != vertex2name.end(); ++t) {
-            if (t->empty()) continue;
-            os << "  \"" << *t << "\"";
-            std::map<std::string,std::string>::const_iterator e =
-                    name2label.find(*t);
+        for (VertexNumber v = 1; v <= vMax; ++v) {
+            std::string const& t = names.name(vertex2name[v]);
+            os << "  \"" << t << "\"";
+            std::unordered_map<std::string,std::string>::const_iterator e =
+                    name2label.find(t);
             if (e != name2label.end()) {
                 os << "[label=\"" << e->second << "\"]";
             }
-            e = name2color.find(*t);
+            e = name2color.find(t);
             if (e != name2color.end()) {
                 os << "[color=\"" << e->second << "\",style=filled]";
             }
@@ -631,10 +680,12 @@ public:
 
         for (EdgeNumber a = 0; a < edgeSize(); ++a) {
             EdgeInfo const& e = edgeInfo(a);
-            std::string s1 = vertex2name[e.v1];
-            std::string s2 = vertex2name[e.v2];
-            os << "  \"" << s1 << "\"--\"" << s2 << "\"";
-            std::map<std::string,std::string>::const_iterator t =
+            std::string s1 = names.name(vertex2name[e.v1]);
+            std::string s2 = names.name(vertex2name[e.v2]);
+            if (e.reversed) std::swap(s1, s2);
+            os << "  \"" << s1 << (directed_ ? "\"->\"" : "\"--\"") << s2
+               << "\"";
+            std::unordered_map<std::string,std::string>::const_iterator t =
                     name2label.find(s1 + "," + s2);
             if (t != name2label.end()) {
                 os << "[label=\"" << t->second << "\"]";
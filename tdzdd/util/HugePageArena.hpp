@@ -0,0 +1,241 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <new>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace tdzdd {
+
+/**
+ * Allocator of large memory blocks backed by huge pages.
+ * When enabled, every request of the block size or more is served by its
+ * own anonymous mapping aligned to the huge page size, which is taken from
+ * explicit huge pages (MAP_HUGETLB) if the system has reserved them and
+ * marked for transparent huge pages (MADV_HUGEPAGE) otherwise.
+ * Smaller requests and all requests while disabled go to the global
+ * allocator.
+ * MemoryPool, MyList and MyVector allocate their storage from here, so the
+ * node tables, the state lists and the evaluation tables of large DDs are
+ * covered by few TLB entries.
+ */
+class HugePageArena {
+    static size_t const HUGE_PAGE_SIZE = size_t(2) << 20;
+
+    typedef std::map<void*,size_t> Registry; ///< Mapped blocks and lengths.
+
+    struct Config {
+        bool enabled;
+        bool explicitFailed;
+        size_t blockSize;
+        size_t mappedBytes;
+        std::atomic<size_t> mappedBlocks; ///< Size of the registry.
+        Registry registry;
+
+        Config() :
+                enabled(false), explicitFailed(false),
+                blockSize(HUGE_PAGE_SIZE), mappedBytes(0), mappedBlocks(0) {
+        }
+    };
+
+    static Config& config() {
+        static Config c;
+        return c;
+    }
+
+    static size_t roundUp(size_t n, size_t unit) {
+        return (n + unit - 1) / unit * unit;
+    }
+
+#if defined(__linux__)
+    /**
+     * Maps a block aligned to the huge page size.
+     * Must be called in the critical section.
+     * @param bytes the size of the block.
+     * @return pointer to the block or null.
+     */
+    static void* map(size_t bytes) {
+        Config& c = config();
+        size_t const length = roundUp(bytes, HUGE_PAGE_SIZE);
+        void* p = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+        if (!c.explicitFailed) {
+            p = mmap(0, length, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p == MAP_FAILED) c.explicitFailed = true;
+        }
+#endif
+
+        if (p == MAP_FAILED) {
+            // over-allocate to align the block to a huge page boundary
+            size_t const total = length + HUGE_PAGE_SIZE;
+            char* q = static_cast<char*>(mmap(0, total,
+                    PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1,
+                    0));
+            if (q == MAP_FAILED) return 0;
+
+            size_t const head = roundUp(reinterpret_cast<size_t>(q),
+                    HUGE_PAGE_SIZE) - reinterpret_cast<size_t>(q);
+            if (head > 0) munmap(q, head);
+            munmap(q + head + length, total - head - length);
+            p = q + head;
+#ifdef MADV_HUGEPAGE
+            madvise(p, length, MADV_HUGEPAGE);
+#endif
+        }
+
+        c.registry[p] = length;
+        c.mappedBytes += length;
+        c.mappedBlocks.fetch_add(1, std::memory_order_release);
+        return p;
+    }
+#endif
+
+    /**
+     * Unmaps a block if it has been mapped by this arena.
+     * The registry is not locked while no block is mapped, so that freeing
+     * ordinary blocks costs nothing when the arena is not used.
+     * @param p the block.
+     * @return true if unmapped.
+     */
+    static bool unmap(void* p) {
+#if defined(__linux__)
+        if (config().mappedBlocks.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+        size_t length = 0;
+#ifdef _OPENMP
+#pragma omp critical(HugePageArena)
+#endif
+        {
+            Config& c = config();
+            Registry::iterator t = c.registry.find(p);
+            if (t != c.registry.end()) {
+                length = t->second;
+                c.mappedBytes -= length;
+                c.registry.erase(t);
+                c.mappedBlocks.fetch_sub(1, std::memory_order_release);
+            }
+        }
+        if (length == 0) return false;
+        munmap(p, length);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+public:
+    /**
+     * Enables or disables the arena.
+     * The block size can be changed only while no block is mapped.
+     * @param enable true to serve large requests from huge pages.
+     * @param blockSize the smallest request served from huge pages in bytes
+     *        (0 for the huge page size).
+     */
+    static void configure(bool enable, size_t blockSize = 0) {
+        Config& c = config();
+        c.enabled = enable;
+        if (c.registry.empty()) {
+            c.blockSize = blockSize ? roundUp(blockSize, HUGE_PAGE_SIZE)
+                                    : HUGE_PAGE_SIZE;
+        }
+    }
+
+    /**
+     * Checks if the arena is enabled.
+     * @return true if enabled.
+     */
+    static bool enabled() {
+        return config().enabled;
+    }
+
+    /**
+     * Gets the smallest request served from huge pages.
+     * @return the block size in bytes.
+     */
+    static size_t blockSize() {
+        return config().blockSize;
+    }
+
+    /**
+     * Gets the total size of the blocks currently mapped.
+     * @return the size in bytes.
+     */
+    static size_t mappedBytes() {
+        return config().mappedBytes;
+    }
+
+    /**
+     * Allocates a memory block.
+     * @param bytes the size of the block.
+     * @return pointer to the block.
+     */
+    static void* allocate(size_t bytes) {
+        Config& c = config();
+        if (!c.enabled || bytes < c.blockSize) return ::operator new(bytes);
+
+#if defined(__linux__)
+        void* p;
+#ifdef _OPENMP
+#pragma omp critical(HugePageArena)
+#endif
+        p = map(bytes);
+        if (p == 0) throw std::bad_alloc();
+        return p;
+#else
+        return ::operator new(bytes);
+#endif
+    }
+
+    /**
+     * Deallocates a memory block whose size is known.
+     * @param p pointer to the block.
+     * @param bytes the size given to allocate(size_t).
+     */
+    static void deallocate(void* p, size_t bytes) {
+        if (bytes >= config().blockSize && unmap(p)) return;
+        ::operator delete(p);
+    }
+
+    /**
+     * Deallocates a memory block whose size is unknown.
+     * @param p pointer to the block.
+     */
+    static void deallocate(void* p) {
+        if (unmap(p)) return;
+        ::operator delete(p);
+    }
+};
+
+} // namespace tdzdd
@@ -28,6 +28,7 @@
 #include <iostream>
 #include <stdexcept>
 
+#include "HugePageArena.hpp"
 #include "MyVector.hpp"
 
 namespace tdzdd {
@@ -35,6 +36,7 @@ namespace tdzdd {
 /**
  * Memory pool.
  * Allocated memory blocks are kept until the pool is destructed.
+ * While HugePageArena is enabled, new pools use blocks of its block size.
  */
 class MemoryPool {
     struct Unit {
@@ -43,18 +45,33 @@ class MemoryPool {
 
     static size_t const UNIT_SIZE = sizeof(Unit);
     static size_t const BLOCK_UNITS = 400000 / UNIT_SIZE;
-    static size_t const MAX_ELEMENT_UNIS = BLOCK_UNITS / 10;
 
     Unit* blockList;
+    size_t blockUnits;
     size_t nextUnit;
 
+    static size_t defaultBlockUnits() {
+        return HugePageArena::enabled() ?
+                HugePageArena::blockSize() / UNIT_SIZE : BLOCK_UNITS;
+    }
+
+    static Unit* newBlock(size_t units) {
+        return static_cast<Unit*>(HugePageArena::allocate(units * UNIT_SIZE));
+    }
+
+    static void deleteBlock(Unit* block) {
+        HugePageArena::deallocate(block);
+    }
+
 public:
     MemoryPool()
-            : blockList(0), nextUnit(BLOCK_UNITS) {
+            : blockList(0), blockUnits(defaultBlockUnits()),
+              nextUnit(blockUnits) {
     }
 
     MemoryPool(MemoryPool const& o)
-            : blockList(0), nextUnit(BLOCK_UNITS) {
+            : blockList(0), blockUnits(defaultBlockUnits()),
+              nextUnit(blockUnits) {
 //        if (o.blockList != 0) throw std::runtime_error(
 //                "MemoryPool can't be copied unless it is empty!"); //FIXME
     }
@@ -79,6 +96,7 @@ public:
 
     void moveFrom(MemoryPool& o) {
         blockList = o.blockList;
+        blockUnits = o.blockUnits;
         nextUnit = o.nextUnit;
         o.blockList = 0;
     }
@@ -95,9 +113,9 @@ public:
         while (blockList != 0) {
             Unit* block = blockList;
             blockList = blockList->next;
-            delete[] block;
+            deleteBlock(block);
         }
-        nextUnit = BLOCK_UNITS;
+        nextUnit = blockUnits;
     }
 
     void reuse() {
@@ -105,7 +123,7 @@ public:
         while (blockList->next != 0) {
             Unit* block = blockList;
             blockList = blockList->next;
-            delete[] block;
+            deleteBlock(block);
         }
         nextUnit = 1;
     }
@@ -120,18 +138,19 @@ public:
         }
 
         blockList = o.blockList;
+        blockUnits = o.blockUnits;
         nextUnit = o.nextUnit;
 
         o.blockList = 0;
-        o.nextUnit = BLOCK_UNITS;
+        o.nextUnit = o.blockUnits;
     }
 
     void* alloc(size_t n) {
         size_t const elementUnits = (n + UNIT_SIZE - 1) / UNIT_SIZE;
 
-        if (elementUnits > MAX_ELEMENT_UNIS) {
+        if (elementUnits > blockUnits / 10) {
             size_t m = elementUnits + 1;
-            Unit* block = new Unit[m];
+            Unit* block = newBlock(m);
             if (blockList == 0) {
                 block->next = 0;
                 blockList = block;
@@ -143,12 +162,12 @@ public:
             return block + 1;
         }
 
-        if (nextUnit + elementUnits > BLOCK_UNITS) {
-            Unit* block = new Unit[BLOCK_UNITS];
+        if (nextUnit + elementUnits > blockUnits) {
+            Unit* block = newBlock(blockUnits);
             block->next = blockList;
             blockList = block;
             nextUnit = 1;
-            assert(nextUnit + elementUnits <= BLOCK_UNITS);
+            assert(nextUnit + elementUnits <= blockUnits);
         }
 
         Unit* p = blockList + nextUnit;
@@ -24,15 +24,18 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <stdexcept>
 
+#include "HugePageArena.hpp"
+
 namespace tdzdd {
 
 template<typename T, size_t BLOCK_ELEMENTS = 1000>
 class MyList {
-    static int const headerCells = 1;
+    static int const headerCells = 2; ///< block size and the front link
 
     struct Cell {
         Cell* next;
@@ -66,6 +69,31 @@ class MyList {
         return reinterpret_cast<T*>(p + 1);
     }
 
+    static size_t& blockCells(Cell* block) {
+        return *reinterpret_cast<size_t*>(block);
+    }
+
+    /**
+     * Allocates a block; while HugePageArena is enabled, the block size is
+     * doubled from the previous one until it reaches the arena block size.
+     */
+    Cell* newBlock(size_t n) {
+        size_t m = headerCells + n * BLOCK_ELEMENTS;
+        if (HugePageArena::enabled() && front_ != 0) {
+            size_t const prev = blockCells(blockStart(front_));
+            size_t const limit = HugePageArena::blockSize() / sizeof(Cell);
+            if (m < prev * 2) m = std::min(prev * 2, std::max(m, limit));
+        }
+        Cell* block = static_cast<Cell*>(
+                HugePageArena::allocate(m * sizeof(Cell)));
+        blockCells(block) = m;
+        return block;
+    }
+
+    static void deleteBlock(Cell* block) {
+        HugePageArena::deallocate(block, blockCells(block) * sizeof(Cell));
+    }
+
 public:
     MyList()
             : front_(0), size_(0) {
@@ -127,7 +155,7 @@ public:
                 p = p->next;
             }
 
-            delete[] blockStart(front_);
+            deleteBlock(blockStart(front_));
             front_ = clearFlag(p);
         }
         size_ = 0;
@@ -160,10 +188,9 @@ public:
         size_t const n = numCells(numElements * sizeof(T)) + 1;
 
         if (front_ == 0 || front_ < blockStart(front_) + headerCells + n) {
-            size_t const m = headerCells + n * BLOCK_ELEMENTS;
-            Cell* newBlock = new Cell[m];
-            Cell* newFront = newBlock + m - n;
-            blockStart(newFront) = newBlock;
+            Cell* block = newBlock(n);
+            Cell* newFront = block + blockCells(block) - n;
+            blockStart(newFront) = block;
             newFront->next = setFlag(front_);
             front_ = newFront;
         }
@@ -186,7 +213,7 @@ public:
         Cell* next = front_->next;
 
         if (flagged(next)) {
-            delete[] blockStart(front_);
+            deleteBlock(blockStart(front_));
             front_ = clearFlag(next);
         }
         else {
@@ -28,6 +28,8 @@
 #include <cstring>
 #include <vector>
 
+#include "HugePageArena.hpp"
+
 namespace tdzdd {
 
 template<typename T, typename Size = size_t>
@@ -37,11 +39,11 @@ class MyVector {
     T* array_;         ///< Start address of the array.
 
     static T* allocate(Size n) {
-        return std::allocator<T>().allocate(n);
+        return static_cast<T*>(HugePageArena::allocate(sizeof(T) * n));
     }
 
     static void deallocate(T* p, Size n) {
-        std::allocator<T>().deallocate(p, n);
+        HugePageArena::deallocate(p, sizeof(T) * n);
     }
 
     void ensureCapacity(Size capacity) {
@@ -0,0 +1,126 @@
+/*
+ * TdZdd: a Top-down/Breadth-first Decision Diagram Manipulation Framework
+ * by Hiroaki Iwashita <iwashita@erato.ist.hokudai.ac.jp>
+ * Copyright (c) 2014 ERATO MINATO Project
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace tdzdd {
+
+/**
+ * Table of distinct strings numbered from 0 in order of arrival.
+ * Names are looked up by pointer and length in an open-addressing hash
+ * table, so that finding a known name does not allocate memory.
+ */
+class StringInterner {
+    std::vector<std::string> names;
+    std::vector<int> table; ///< Name number plus one; 0 for an empty slot.
+    size_t mask;
+
+    static size_t hash(char const* s, size_t n) {
+        uint64_t h = 14695981039346656037ULL;
+        for (size_t i = 0; i < n; ++i) {
+            h ^= static_cast<unsigned char>(s[i]);
+            h *= 1099511628211ULL;
+        }
+        return h ^ (h >> 32);
+    }
+
+    size_t slot(char const* s, size_t n) const {
+        for (size_t i = hash(s, n) & mask;; i = (i + 1) & mask) {
+            if (table[i] == 0) return i;
+            std::string const& t = names[table[i] - 1];
+            if (t.size() == n && std::memcmp(t.data(), s, n) == 0) return i;
+        }
+    }
+
+    void grow() {
+        table.assign(table.size() * 2, 0);
+        mask = table.size() - 1;
+        for (size_t k = 0; k < names.size(); ++k) {
+            table[slot(names[k].data(), names[k].size())] = k + 1;
+        }
+    }
+
+public:
+    StringInterner()
+            : table(16), mask(15) {
+    }
+
+    /**
+     * Gets the number of a name, adding the name if it is new.
+     * @param s the first character of the name.
+     * @param n the length of the name.
+     * @return the name number.
+     */
+    int intern(char const* s, size_t n) {
+        size_t i = slot(s, n);
+        if (table[i] != 0) return table[i] - 1;
+
+        if ((names.size() + 1) * 2 > table.size()) {
+            grow();
+            i = slot(s, n);
+        }
+        names.push_back(std::string(s, n));
+        table[i] = names.size();
+        return names.size() - 1;
+    }
+
+    int intern(std::string const& s) {
+        return intern(s.data(), s.size());
+    }
+
+    /**
+     * Gets the number of a name.
+     * @param s the first character of the name.
+     * @param n the length of the name.
+     * @return the name number; -1 if the name is unknown.
+     */
+    int find(char const* s, size_t n) const {
+        return table[slot(s, n)] - 1;
+    }
+
+    int find(std::string const& s) const {
+        return find(s.data(), s.size());
+    }
+
+    std::string const& name(int k) const {
+        return names[k];
+    }
+
+    int size() const {
+        return names.size();
+    }
+
+    void clear() {
+        names.clear();
+        table.assign(16, 0);
+        mask = 15;
+    }
+};
+
+} // namespace tdzdd
@@ -0,0 +1,164 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Read-only view of the whole contents of a file.
+ * A regular file is mapped into memory; anything else, such as a pipe, is
+ * read into a buffer.
+ */
+class MappedFile {
+    char const* data;
+    size_t size_;
+    void* mapped;
+    std::vector<char> buffer;
+
+    MappedFile(MappedFile const&);
+    MappedFile& operator=(MappedFile const&);
+
+public:
+    /**
+     * Constructor.
+     * @param fileName the file name.
+     * @exception std::runtime_error the file cannot be opened.
+     */
+    explicit MappedFile(std::string const& fileName)
+            : data(0), size_(0), mapped(MAP_FAILED) {
+        int fd = open(fileName.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error(
+                "ERROR: cannot open " + fileName);
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            size_ = st.st_size;
+            mapped = mmap(0, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+
+        if (mapped != MAP_FAILED) {
+            madvise(mapped, size_, MADV_SEQUENTIAL);
+            data = static_cast<char const*>(mapped);
+        }
+        else {
+            std::ifstream ifs(fileName.c_str(), std::ios::binary);
+            buffer.assign(std::istreambuf_iterator<char>(ifs),
+                          std::istreambuf_iterator<char>());
+            size_ = buffer.size();
+            data = buffer.empty() ? 0 : &buffer[0];
+        }
+    }
+
+    ~MappedFile() {
+        if (mapped != MAP_FAILED) munmap(mapped, size_);
+    }
+
+    char const* begin() const {
+        return data;
+    }
+
+    char const* end() const {
+        return data + size_;
+    }
+};
+
+/**
+ * Splitter of text into tokens and lines without copying.
+ * Tokens are separated by spaces, tabs and carriage returns, and also by
+ * commas if requested.
+ */
+class Tokenizer {
+    char const* p;
+    char const* const end;
+    bool const comma;
+
+    bool isSeparator(char c) const {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v'
+                || (comma && c == ',');
+    }
+
+public:
+    /**
+     * Constructor.
+     * @param begin the first character of the text.
+     * @param end the end of the text.
+     * @param comma true if commas separate tokens.
+     */
+    Tokenizer(char const* begin, char const* end, bool comma = false)
+            : p(begin), end(end), comma(comma) {
+    }
+
+    /**
+     * Checks if the whole text has been read.
+     * @return true at the end of the text.
+     */
+    bool eof() const {
+        return p == end;
+    }
+
+    /**
+     * Gets the next token on the current line.
+     * @param s receives the first character of the token.
+     * @param n receives the length of the token.
+     * @return false if the line has no more tokens.
+     */
+    bool nextInLine(char const*& s, size_t& n) {
+        while (p != end && isSeparator(*p)) {
+            ++p;
+        }
+        if (p == end || *p == '\n') return false;
+        s = p;
+        while (p != end && *p != '\n' && !isSeparator(*p)) {
+            ++p;
+        }
+        n = p - s;
+        return true;
+    }
+
+    /**
+     * Gets the next token, going over line breaks.
+     * @param s receives the first character of the token.
+     * @param n receives the length of the token.
+     * @return false at the end of the text.
+     */
+    bool next(char const*& s, size_t& n) {
+        while (!nextInLine(s, n)) {
+            if (p == end) return false;
+            ++p;
+        }
+        return true;
+    }
+
+    /**
+     * Skips the rest of the current line including the line break.
+     */
+    void nextLine() {
+        while (p != end && *p++ != '\n') {
+        }
+    }
+
+    /**
+     * Converts a token to a number.
+     * @param s the first character of the token.
+     * @param n the length of the token.
+     * @param x receives the number.
+     * @return false if the token does not start with a number.
+     */
+    static bool toDouble(char const* s, size_t n, double& x) {
+        char buf[64];
+        if (n >= sizeof(buf)) n = sizeof(buf) - 1;
+        std::memcpy(buf, s, n);
+        buf[n] = '\0';
+        char* q;
+        x = std::strtod(buf, &q);
+        return q != buf;
+    }
+};
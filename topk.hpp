@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <stdint.h>
+#include <vector>
+
+#include "tdzdd/DdEval.hpp"
+#include "tdzdd/FlatDdStructure.hpp"
+#include "tdzdd/util/MyVector.hpp"
+
+/**
+ * Enumerator of the most probable assignments reaching one terminal of a
+ * BDD, in the order of decreasing probability.
+ *
+ * Each level is a variable that takes 1 with the given probability.
+ * The weight of a branch is its log probability, so that the most probable
+ * assignments are the longest paths from the root to the terminal.
+ * One bottom-up pass computes the best log probability of completing an
+ * assignment from each node.  The best-first search below then uses it
+ * as an exact estimate: every partial assignment taken out of the queue
+ * lies on the next most probable assignment, and each assignment costs
+ * one queue operation per level.  Levels skipped by an edge of the BDD
+ * take both values.
+ */
+class TopKConfigurations {
+public:
+    typedef tdzdd::FlatDdStructure<2> Diagram;
+    typedef uint32_t Index;
+
+    /**
+     * Assignment found by the enumeration.
+     */
+    struct Configuration {
+        double prob;              ///< Probability of the assignment.
+        std::vector<int> zeros;   ///< Levels taking 0, in decreasing order.
+    };
+
+private:
+    /**
+     * Bottom-up evaluator of the best log probability of completion.
+     */
+    class BestCompletion: public tdzdd::DdEval<BestCompletion,double> {
+        TopKConfigurations const& topk;
+
+    public:
+        BestCompletion(TopKConfigurations const& topk) : topk(topk) {
+        }
+
+        void evalTerminal(double& v, bool one) const {
+            v = one == topk.target ? 0.0 : NEG_INF;
+        }
+
+        void evalNode(double& v, int level,
+                      tdzdd::DdValues<double,2> const& values) const {
+            v = NEG_INF;
+            for (int b = 0; b < 2; ++b) {
+                if (values.get(b) == NEG_INF) continue;
+                double w = topk.logProb[b][level]
+                        + topk.skipped(level - 1, values.getLevel(b))
+                        + values.get(b);
+                if (w > v) v = w;
+            }
+        }
+    };
+
+    /**
+     * Decision at a level, linked to the decision at the level above.
+     */
+    struct Decision {
+        int parent;
+        int level;
+        int value;
+    };
+
+    /**
+     * Partial assignment waiting in the queue.
+     */
+    struct Entry {
+        double key;  ///< Best log probability of a completion.
+        double logp; ///< Log probability of the decisions so far.
+        int last;    ///< The last decision; -1 for none.
+        Index node;  ///< The current node.
+        int level;   ///< The next level to be decided.
+
+        bool operator<(Entry const& o) const {
+            return key < o.key;
+        }
+    };
+
+    static double constexpr NEG_INF = -std::numeric_limits<double>::infinity();
+
+    Diagram const& dd;
+    bool const target;
+    int const numLevels;
+    std::vector<double> logProb[2];
+    std::vector<double> maxSum;
+    tdzdd::MyVector<double> best;
+    std::vector<Decision> decisions;
+    std::priority_queue<Entry> queue;
+
+    /**
+     * Gets the best log probability of the levels from @p from down to
+     * @p to + 1, which may take any value.
+     */
+    double skipped(int from, int to) const {
+        return from > to ? maxSum[from] - maxSum[to] : 0.0;
+    }
+
+    void push(Entry const& e, Index node, int level, int value, double w) {
+        Entry ee;
+        ee.logp = e.logp + w;
+        if (ee.logp == NEG_INF) return;
+        ee.key = ee.logp + skipped(level - 1, dd.level(node)) + best[node];
+        if (ee.key == NEG_INF) return;
+        Decision d = {e.last, level, value};
+        decisions.push_back(d);
+        ee.last = decisions.size() - 1;
+        ee.node = node;
+        ee.level = level - 1;
+        queue.push(ee);
+    }
+
+public:
+    /**
+     * Constructor.
+     * @param dd the BDD.
+     * @param prob probability of taking 1 at each level; index 0 is unused.
+     * @param target the terminal to be reached.
+     */
+    TopKConfigurations(Diagram const& dd, std::vector<double> const& prob,
+                       bool target = true)
+            : dd(dd), target(target), numLevels(prob.size() - 1),
+              maxSum(prob.size()) {
+        for (int b = 0; b < 2; ++b) {
+            logProb[b].resize(prob.size());
+        }
+        maxSum[0] = 0.0;
+        for (int i = 1; i <= numLevels; ++i) {
+            logProb[0][i] = std::log(1.0 - prob[i]);
+            logProb[1][i] = std::log(prob[i]);
+            maxSum[i] = maxSum[i - 1] + std::max(logProb[0][i], logProb[1][i]);
+        }
+
+        dd.evaluate(BestCompletion(*this), best);
+
+        Entry e;
+        e.logp = 0.0;
+        e.key = skipped(numLevels, dd.level(dd.root())) + best[dd.root()];
+        e.last = -1;
+        e.node = dd.root();
+        e.level = numLevels;
+        if (e.key != NEG_INF) queue.push(e);
+    }
+
+    /**
+     * Finds the next most probable assignment.
+     * @param c the assignment found.
+     * @return false if no more assignments exist.
+     */
+    bool next(Configuration& c) {
+        while (!queue.empty()) {
+            Entry const e = queue.top();
+            queue.pop();
+
+            if (e.level == 0) {
+                c.prob = std::exp(e.logp);
+                c.zeros.clear();
+                for (int k = e.last; k >= 0; k = decisions[k].parent) {
+                    if (decisions[k].value == 0) {
+                        c.zeros.push_back(decisions[k].level);
+                    }
+                }
+                std::reverse(c.zeros.begin(), c.zeros.end());
+                return true;
+            }
+
+            int const i = e.level;
+            if (dd.level(e.node) == i) {
+                for (int b = 0; b < 2; ++b) {
+                    push(e, dd.child(e.node, b), i, b, logProb[b][i]);
+                }
+            }
+            else {
+                for (int b = 0; b < 2; ++b) {
+                    push(e, e.node, i, b, logProb[b][i]);
+                }
+            }
+        }
+        return false;
+    }
+};
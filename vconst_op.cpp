@@ -190,3 +190,13 @@ bddp build_ev_bdd(int level, bddp f, const int* is_vertex_list,
     }
     return h;
 }
+
+/**
+ * Forgets the results of insertVAll.
+ * Call it before building another EVBDD after BDD_Init, since the cache
+ * refers to nodes and incidence lists of the previous one.
+ */
+void clear_ev_bdd_cache()
+{
+    insert_vall_cache.clear();
+}
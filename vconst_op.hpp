@@ -2,3 +2,5 @@
 
 bddp build_ev_bdd(int level, bddp f, const int* is_vertex_list,
                     const int* const* inc_list, const int* inc_size_list);
+
+void clear_ev_bdd_cache();
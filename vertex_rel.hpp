@@ -1,6 +1,31 @@
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "tdzdd/DdStructure.hpp"
+#include "tdzdd/util/Graph.hpp"
 #include "vconst_op.hpp"
 #include "ToShiftedBDD.hpp"
 
+/**
+ * Inputs and results of computeVertexReliability.
+ */
+class GlobalVariables {
+public:
+    std::vector<double> edge_prob_list;
+    std::map<std::string, double> vertex_prob_map;
+    std::vector<double> edge_vertex_prob_list;
+    int* v_list;
+    int* e_list;
+    const tdzdd::Graph* graph;
+    const tdzdd::DdStructure<2>* edge_dd;
+    BDD shifted_edge_dd;
+};
+
 /**
  * Computes vertex reliability for a given graph using BDD (Binary Decision Diagram) techniques.
  * 
@@ -157,6 +182,15 @@ bddp computeVertexReliability(GlobalVariables& gv) {
     // Build the final edge-vertex BDD that represents the reliability polynomial
     // This BDD encodes all valid configurations where the graph remains connected
     // considering both edge and vertex failures
+    clear_ev_bdd_cache();
     bddp g = build_ev_bdd(n + m, gv.shifted_edge_dd.GetID(), is_vertex_list, inc_list, inc_size_list);
+
+    // Release the work arrays; the caller owns gv.v_list and gv.e_list
+    for (int i = 1; i < n + m + 1; ++i) {
+        delete[] inc_list[i];
+    }
+    delete[] inc_list;
+    delete[] inc_size_list;
+    delete[] is_vertex_list;
     return g;
 }